@@ -11,8 +11,91 @@
  *  ------------------------------------------------------------------------ */
 
 #include <Wire.h>
-#include <Adafruit_NeoPixel.h>
 #include <Adafruit_MPR121.h>
+#include <atomic>
+#include <type_traits>
+#include <utility>
+
+/* LED output backend per strip, picked at compile time (see LedStrip) */
+#define LED_OUT_NEOPIXEL  0                    // Adafruit_NeoPixel: bit-bang, RMT on ESP32
+#define LED_OUT_RMT       1                    // ESP32 RMT driver, one channel per strip
+#define LED_OUT_MOCK      2                    // keeps the last frame in memory
+#define LED_OUT_RECORDER  3                    // appends every frame to LED_RECORD_PATH
+#define LED_OUT_SPI       4                    // ESP32 SPI MOSI + DMA, bits as symbols
+
+#ifndef LED_OUT
+#  if defined(ARDUINO)
+#    define LED_OUT  LED_OUT_NEOPIXEL
+#  else
+#    define LED_OUT  LED_OUT_MOCK              // host build
+#  endif
+#endif
+#ifndef LED_OUT_GYRO
+#  define LED_OUT_GYRO  LED_OUT
+#endif
+#ifndef LED_OUT_TURN
+#  define LED_OUT_TURN  LED_OUT
+#endif
+#ifndef LED_OUT_MAIN
+#  if LED_OUT == LED_OUT_SPI                   // two SPI hosts: the third strip on RMT
+#    define LED_OUT_MAIN  LED_OUT_RMT
+#  else
+#    define LED_OUT_MAIN  LED_OUT
+#  endif
+#endif
+#ifndef SPI_LED_BITS                           // SPI bits per LED bit, 3 or 4
+#  define SPI_LED_BITS  4
+#endif
+#ifndef SPI_LED_HZ
+#  define SPI_LED_HZ    3200000
+#endif
+#ifndef LED_RECORD_PATH
+#  define LED_RECORD_PATH  "leds.rec"
+#endif
+#define LED_USES(kind)  (LED_OUT_GYRO == (kind) || LED_OUT_TURN == (kind) || \
+                         LED_OUT_MAIN == (kind))
+
+#if LED_USES(LED_OUT_NEOPIXEL)
+#  include <Adafruit_NeoPixel.h>
+#endif
+#if LED_USES(LED_OUT_RMT)
+#  if !defined(ESP32)
+#    error "LED_OUT_RMT needs an ESP32"
+#  endif
+#  include <driver/rmt.h>
+#endif
+#if LED_USES(LED_OUT_SPI)
+#  if !defined(ESP32)
+#    error "LED_OUT_SPI needs an ESP32"
+#  endif
+#  if (LED_OUT_GYRO == LED_OUT_SPI) + (LED_OUT_TURN == LED_OUT_SPI) + \
+      (LED_OUT_MAIN == LED_OUT_SPI) > 2
+#    error "only SPI2 and SPI3 are free – put one strip on LED_OUT_RMT"
+#  endif
+#  include <driver/spi_master.h>
+#  include <esp_heap_caps.h>
+#endif
+#if LED_USES(LED_OUT_RECORDER)
+#  include <stdio.h>
+#endif
+
+#ifndef SCRIPT_COROUTINES                      // C++20 coroutines where available
+#  if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#    define SCRIPT_COROUTINES  1
+#  else
+#    define SCRIPT_COROUTINES  0
+#  endif
+#endif
+#if SCRIPT_COROUTINES
+#  include <coroutine>
+#endif
+
+#if defined(ESP32)
+#  include <esp_sleep.h>
+#  include <esp_timer.h>
+#  include <driver/rtc_io.h>
+#  include <Preferences.h>
+#endif
 
 #ifndef _BV
 #  define _BV(bit)  (1U << (bit))
@@ -25,565 +108,3238 @@ constexpr uint8_t  PIN_GYRO         = 2;   // Gyro beacon strip
 constexpr uint8_t  PIN_TURN         = 0;   // Turn-signal strip
 constexpr uint8_t  PIN_HEAD_TAIL    = 4;   // Head-/tail-light strip
 constexpr uint8_t  POT_PIN          = 13;  // Analogue pot for brightness / colour
+                                           // (unused with INPUT_SLIDER)
 
 constexpr uint8_t  NUM_GYRO_PIXELS       = 8;
 constexpr uint8_t  NUM_TURN_PIXELS       = 4;
 constexpr uint8_t  NUM_HEADTAIL_PIXELS   = 8;
 
-/* ---------------------------------------------------------------------------
- *  Timing (half-periods, in ms)
- * ------------------------------------------------------------------------ */
-constexpr uint16_t HP_TURN  = 500;
-constexpr uint16_t HP_GYRO  = 500;
+constexpr uint8_t MAX_STRIP_PIXELS = 8;
+static_assert(NUM_GYRO_PIXELS <= MAX_STRIP_PIXELS && NUM_TURN_PIXELS <= MAX_STRIP_PIXELS &&
+              NUM_HEADTAIL_PIXELS <= MAX_STRIP_PIXELS, "raise MAX_STRIP_PIXELS");
 
 /* ---------------------------------------------------------------------------
- *  Touch IDs (one bit per electrode)
+ *  Touch sensor bus
  * ------------------------------------------------------------------------ */
-constexpr uint16_t TK_GYRO          = _BV(0);
-constexpr uint16_t TK_TURN_R        = _BV(1);
-constexpr uint16_t TK_TURN_L        = _BV(2);
-constexpr uint16_t TK_HEAD          = _BV(3);
-constexpr uint16_t TK_TAIL          = _BV(4);
-constexpr uint16_t TK_CTRL          = _BV(5);
-constexpr uint16_t TK_SHOW          = _BV(6);
+constexpr uint8_t  MPR121_ADDR      = 0x5A;    // sensor n sits at 0x5A + n
+#ifndef NUM_TOUCH_SENSORS                      // 1…4 (ADDR pin → 0x5A…0x5D)
+#  define NUM_TOUCH_SENSORS 1
+#endif
+constexpr uint32_t TOUCH_I2C_HZ     = 400000;  // MPR121 is rated for 400 kHz;
+                                               // 1 MHz works on short traces only
+/* One burst is the address, the register, the repeated-start address and
+   43 data bytes at 9 bit times each: 1035 µs per sensor at 400 kHz, longer
+   than the chip's 1 ms sample interval.  The poll period is the next whole
+   ms (the touch task sleeps in ticks) above a pass over every sensor, so
+   the bus is never saturated. */
+constexpr uint8_t  TOUCH_BURST_BYTES = 3 + 0x2B;
+constexpr uint32_t TOUCH_BURST_US   = (TOUCH_BURST_BYTES * 9 * 1000000ul + TOUCH_I2C_HZ - 1) / TOUCH_I2C_HZ;
+constexpr uint16_t TOUCH_POLL_US    = (NUM_TOUCH_SENSORS * TOUCH_BURST_US / 1000 + 1) * 1000;
+
+/* IRQ line per sensor (active low); TOUCH_NO_IRQ = not wired → always polled */
+constexpr uint8_t  TOUCH_NO_IRQ     = 0xFF;
+#ifndef TOUCH_IRQ0                             // sensor 0's IRQ GPIO, enables LOW_POWER
+#  define TOUCH_IRQ0  TOUCH_NO_IRQ
+#endif
+#ifndef TOUCH_IRQ1
+#  define TOUCH_IRQ1  TOUCH_NO_IRQ
+#endif
+#ifndef TOUCH_IRQ2
+#  define TOUCH_IRQ2  TOUCH_NO_IRQ
+#endif
+#ifndef TOUCH_IRQ3
+#  define TOUCH_IRQ3  TOUCH_NO_IRQ
+#endif
+constexpr uint8_t  TOUCH_IRQ_PIN[4] = { TOUCH_IRQ0, TOUCH_IRQ1,
+                                        TOUCH_IRQ2, TOUCH_IRQ3 };
+constexpr uint16_t TOUCH_REFRESH_MS = 16;      // quiet sensors still refresh data
+
+static_assert(NUM_TOUCH_SENSORS >= 1 && NUM_TOUCH_SENSORS <= 4,
+              "MPR121 address range is 0x5A…0x5D");
+
+constexpr uint16_t CAL_SETTLE_MS    = 2000;    // learn this long before caching
+constexpr uint8_t  CAL_TOLERANCE    = 12;      // counts; beyond = environment changed
 
-constexpr uint16_t TK_HAZARD        = TK_TURN_R | TK_TURN_L;
-constexpr uint16_t TK_LOW_BEAM      = TK_HEAD    | TK_TAIL;
-constexpr uint16_t TK_HEAD_COL      = TK_CTRL    | TK_HEAD;
-constexpr uint16_t TK_TAIL_COL      = TK_CTRL    | TK_TAIL;
+constexpr uint16_t SENSOR_RETRY_MS  = 50;      // first retry of a missing sensor …
+constexpr uint16_t SENSOR_RETRY_MAX = 5000;    // … doubling up to this
+constexpr uint16_t FIRST_FRAME_MS   = 50;      // boot budget for the first frame
+
+#ifndef TOUCH_SW_DETECT                        // 1 = decide touches on the host
+#  define TOUCH_SW_DETECT   0
+#endif
+
+#ifndef INPUT_SLIDER                           // 1 = electrode slider instead of POT_PIN
+#  define INPUT_SLIDER      0
+#endif
+
+#ifndef LED_DITHER                             // 1 = 16-bit intensities, temporal dither
+#  define LED_DITHER        0
+#endif
+constexpr uint16_t DITHER_FRAME_US  = 2500;    // 400 Hz refresh of fractional strips
+
+#ifndef LED_GAMMA                              // 1 = gamma 2.2 in the output encode
+#  define LED_GAMMA         0
+#endif
+
+#ifndef LAMP_MODEL                             // 1 = turn / tail pixels behave like bulbs
+#  define LAMP_MODEL        0
+#endif
+constexpr uint16_t LAMP_FRAME_US    = 5000;    // 200 Hz while a filament settles
+constexpr uint16_t LAMP_TAU_UP_MS   = 60;      // heat-up time constant
+constexpr uint16_t LAMP_TAU_DOWN_MS = 200;     // cool-down, slower
+
+#define LED_SHADOW  (LED_DITHER || LAMP_MODEL)  // output stage keeps its own frame
+
+#ifndef TOUCH_BACKGROUND                       // poll from a task on the other core
+#  if defined(ESP32)
+#    define TOUCH_BACKGROUND  1
+#  else
+#    define TOUCH_BACKGROUND  0
+#  endif
+#endif
 
 /* ---------------------------------------------------------------------------
- *  Objects
+ *  Low power – needs sensor 0's IRQ wired to an RTC-capable GPIO
  * ------------------------------------------------------------------------ */
-Adafruit_NeoPixel pxGyro (NUM_GYRO_PIXELS,     PIN_GYRO,      NEO_GRB + NEO_KHZ800);
-Adafruit_NeoPixel pxTurn (NUM_TURN_PIXELS,     PIN_TURN,      NEO_GRB + NEO_KHZ800);
-Adafruit_NeoPixel pxMain (NUM_HEADTAIL_PIXELS, PIN_HEAD_TAIL, NEO_GRB + NEO_KHZ800);
-
-Adafruit_MPR121   cap;
+constexpr bool     LOW_POWER        = TOUCH_IRQ_PIN[0] != TOUCH_NO_IRQ;
+constexpr uint32_t IDLE_SLEEP_MS    = 60000;   // no touch and nothing blinking
+constexpr uint8_t  PROX_TOUCH_THR   = 4;       // combined-electrode thresholds
+constexpr uint8_t  PROX_RELEASE_THR = 2;
 
 /* ---------------------------------------------------------------------------
- *  State flags
+ *  Timing (half-periods, in ms)
  * ------------------------------------------------------------------------ */
-bool gyroEnabled         = false;
-bool turnR_Enabled       = false;
-bool turnL_Enabled       = false;
-bool hazardEnabled       = false;
-bool headEnabled         = false;
-bool tailEnabled         = false;
-bool lowBeamEnabled      = false;
+constexpr uint16_t HP_TURN  = 500;
+constexpr uint16_t HP_GYRO  = 500;
 
-bool cfgGyroBrightness   = false;
-bool cfgTurnBrightness   = false;
-bool cfgMainBrightness   = false;
-bool cfgColour           = false;
+/* Tap tempo: the half-periods above are in tempo ms, 500 of which make one
+   beat; at the default 120 BPM tempo ms are real ms */
+constexpr uint16_t TEMPO_BEAT_MS  = 500;
+constexpr uint16_t TEMPO_MIN_MS   = 250;       // 240 BPM
+constexpr uint16_t TEMPO_MAX_MS   = 1500;      //  40 BPM
+constexpr uint16_t TAP_TIMEOUT_MS = 2000;      // longer gap starts a new count
+constexpr uint8_t  TAP_HISTORY    = 5;         // intervals in the median
+constexpr uint8_t  TEMPO_SLEW_DIV = 8;         // phase catch-up ≤ 1/8 of real time
 
-/* Runtime helpers */
-unsigned long tLastGyro      = 0;
-unsigned long tLastTurnR     = 0;
-unsigned long tLastTurnL     = 0;
-unsigned long tLastHazard    = 0;
+#ifndef SEQ_TURN                               // 1 = sequential (sweeping) turn signals
+#  define SEQ_TURN  0
+#endif
+constexpr uint16_t SEQ_STEP_MS   = 80;         // per pixel, inside out
 
-/* Double-tap bookkeeping */
-struct TapTimer {
-  uint8_t       count  = 0;
-  unsigned long first  = 0;
-};
-TapTimer tapGyro, tapTurnR, tapTurnL, tapMain;
+#ifndef RUN_AHEAD                              // frame edges rendered ahead, 0 = inline
+#  define RUN_AHEAD  4
+#endif
+
+constexpr uint16_t CHORD_SKEW_MS = 100;        // max gap between chord fingers
+
+constexpr uint16_t LONG_PRESS_MS = 600;        // hold → brightness auto-repeat
+constexpr uint16_t REPEAT_MS[]   = { 200, 50, 20 };
+constexpr uint8_t  REPEAT_AFTER[] = { 4, 12 };  // steps before each speed-up
 
 /* ---------------------------------------------------------------------------
- *  User presets (will be updated from setup loops)
+ *  Touch IDs (one bit per electrode, 12 bits per sensor → 48-bit mask)
  * ------------------------------------------------------------------------ */
-uint8_t  brGyroInit   = 100;                                // 0-255
-uint8_t  brTurnInit   = 100;
-uint8_t  brMainInit   = 100;
+typedef uint64_t TouchMask;
 
-uint32_t colHeadInit  = pxMain.Color(230, 240, 255);        // bluish-white
-uint32_t colTailInit  = pxMain.Color(255,   0,   0);        // red
-uint32_t colTurnInit  = pxMain.Color(255, 165,   0);        // amber
-uint32_t colGyroA     = pxMain.Color(255,   0,   0);        // red
-uint32_t colGyroB     = pxMain.Color(  0,   0, 255);        // blue
+constexpr TouchMask tk(uint8_t electrode, uint8_t sensor = 0)
+{
+  return TouchMask(1) << (sensor * 12 + electrode);
+}
 
-/* Demo / show-mode colours */
-const uint32_t colShowGyroA = pxMain.Color( 38, 196, 236);
-const uint32_t colShowGyroB = pxMain.Color( 20, 148,  20);
-const uint32_t colShowTurn  = pxMain.Color(187, 210, 225);
-const uint32_t colShowMain  = pxMain.Color(255,   0, 127);
+constexpr TouchMask TK_GYRO          = tk(0);
+constexpr TouchMask TK_TURN_R        = tk(1);
+constexpr TouchMask TK_TURN_L        = tk(2);
+constexpr TouchMask TK_HEAD          = tk(3);
+constexpr TouchMask TK_TAIL          = tk(4);
+constexpr TouchMask TK_CTRL          = tk(5);
+constexpr TouchMask TK_SHOW          = tk(6);
+
+constexpr TouchMask TK_HAZARD        = TK_TURN_R | TK_TURN_L;
+constexpr TouchMask TK_LOW_BEAM      = TK_HEAD    | TK_TAIL;
+constexpr TouchMask TK_HEAD_COL      = TK_CTRL    | TK_HEAD;
+constexpr TouchMask TK_TAIL_COL      = TK_CTRL    | TK_TAIL;
+constexpr TouchMask TK_GYRO_COL      = TK_CTRL    | TK_GYRO;
+constexpr TouchMask TK_RAINBOW       = TK_CTRL    | TK_SHOW;
+
+constexpr TouchMask CHORDS[]         = { TK_HAZARD, TK_LOW_BEAM, TK_HEAD_COL,
+                                         TK_TAIL_COL, TK_GYRO_COL, TK_RAINBOW };
 
 /* ---------------------------------------------------------------------------
- *  Forward declarations
+ *  LED output HAL
+ *  --------------
+ *  PixelBuffer holds a strip's frame in wire order with the Adafruit_NeoPixel
+ *  setPixelColor() / setBrightness() / Color() interface.  setPixelColor()
+ *  is the whole encode in one pass: brightness, gamma and the strip's white
+ *  balance are folded into one 256-entry table per channel, rebuilt by
+ *  setBrightness(), and the three results are stored at their compile-time
+ *  wire offsets.  A new brightness applies to pixels set after it (every
+ *  stripBrightness() caller repaints).
+ *  The buffer is the frame the peripheral sends: a backend that owns
+ *  transmit storage hands it out through frame() and the pixels are encoded
+ *  straight into it, otherwise PixelBuffer's own word-aligned array is used
+ *  and write() gets a pointer to it.  Either way show() copies no pixels.
+ *  Colours stay 0x00RRGGBB everywhere above this layer; the reorder is
+ *  the kernel's compile-time offsets.  The SPI backend still expands each
+ *  byte to symbols, and the LED_SHADOW output stage keeps its 16-bit copy.
+ *  LedStrip<Backend> adds the transmit, a plain member call on a policy type,
+ *  so nothing on the pixel or show path is virtual.  A backend is
+ *  constructible from (pin, pixel count) and has begin(), frame() (its own
+ *  transmit buffer or nullptr) and write(wire, bytes), which sends one frame
+ *  and returns when the line may latch it; the static_assert in LedStrip
+ *  holds every backend to that.
  * ------------------------------------------------------------------------ */
-void clearStrip(Adafruit_NeoPixel &strip);
-void toggleGyro  (bool state, uint32_t c1, uint32_t c2);
-void toggleTurnR (bool state, uint32_t c);
-void toggleTurnL (bool state, uint32_t c);
-void toggleHazard(bool state, uint32_t c);
-void toggleHead  (bool state, uint32_t c);
-void toggleTail  (bool state, uint32_t c);
-void toggleLowBeam(bool state, uint32_t c);
+constexpr uint16_t LED_T0H_NS   = 300;         // SK6812 nominal, 1.2 µs bit
+constexpr uint16_t LED_T0L_NS   = 900;
+constexpr uint16_t LED_T1H_NS   = 600;
+constexpr uint16_t LED_T1L_NS   = 600;
+constexpr uint16_t LED_RESET_US = 300;         // low time that latches a frame
 
-uint8_t  potToBrightness(int raw);
-uint32_t potToWhiteShade (int raw);
-uint32_t potToRedShade   (int raw);
-uint32_t potToAmberShade (int raw);
+/* SK6812 datasheet windows (ns), ±150 around nominal; the bit period is
+   1.25 µs ± 600 ns */
+struct PulseWindow { uint16_t lo, hi; };
+constexpr PulseWindow SK_T0H = {  150,  450 };
+constexpr PulseWindow SK_T0L = {  750, 1050 };
+constexpr PulseWindow SK_T1H = {  450,  750 };
+constexpr PulseWindow SK_T1L = {  450,  750 };
+constexpr PulseWindow SK_BIT = {  650, 1850 };
 
-void waitRelease(uint8_t electrode);
+constexpr bool inWindow(uint32_t ps, PulseWindow w) { return ps >= w.lo * 1000UL && ps <= w.hi * 1000UL; }
 
-/* ---------------------------------------------------------------------------
- *  SETUP
- * ------------------------------------------------------------------------ */
-void setup()
+/* Wire offsets of R, G and B; one order for all strips */
+template<uint8_t R, uint8_t G, uint8_t B>
+struct ColourOrder { static constexpr uint8_t r = R, g = G, b = B; };
+using OrderGRB = ColourOrder<1, 0, 2>;
+using OrderRGB = ColourOrder<0, 1, 2>;
+using LedOrder = OrderGRB;                     // NEO_GRB
+
+/* Per-strip channel gains, 255 = unity; trims tint differences between
+   LED batches */
+struct WhiteBalance { uint8_t r, g, b; };
+constexpr WhiteBalance WB_GYRO = { 255, 255, 255 };
+constexpr WhiteBalance WB_TURN = { 255, 255, 255 };
+constexpr WhiteBalance WB_MAIN = { 255, 255, 255 };
+
+/* 255 · (v / 255)^2.2, computed at compile time as the fifth root of v^11 */
+struct Gamma8 { uint8_t v[256]; };
+constexpr double root5(double a)
 {
-  Serial.begin(9600);
+  double y = 1;
+  for (uint8_t k = 0; k < 100; ++k) y -= (y - a / (y * y * y * y)) / 5;   // Newton
+  return y;
+}
+constexpr double gamma22(int v)                // (v / 255)^2.2
+{
+  double x = v / 255.0, x11 = x;
+  for (uint8_t k = 1; k < 11; ++k) x11 *= x;
+  return root5(x11);
+}
+constexpr Gamma8 makeGamma8()
+{
+  Gamma8 t{};
+  for (int v = 0; v < 256; ++v) t.v[v] = LED_GAMMA ? uint8_t(255 * gamma22(v) + 0.5) : uint8_t(v);
+  return t;
+}
+constexpr Gamma8 GAMMA8 = makeGamma8();        // .rodata → flash
 
-  pxGyro.begin();
-  pxTurn.begin();
-  pxMain.begin();
+/* The same curve in 8.8 (255.0 at the top) for the LED_SHADOW output
+   stage, which applies it before its dither, not after */
+struct Gamma16 { uint16_t v[256]; };
+constexpr Gamma16 makeGamma16()
+{
+  Gamma16 t{};
+  for (int v = 0; v < 256; ++v) t.v[v] = LED_GAMMA ? uint16_t(65280 * gamma22(v) + 0.5) : uint16_t(v << 8);
+  return t;
+}
+constexpr Gamma16 GAMMA16 = makeGamma16();
 
-  pxGyro.setBrightness(brGyroInit);
-  pxTurn.setBrightness(brTurnInit);
-  pxMain.setBrightness(brMainInit);
+/* The fused kernel: one table read per channel, written in wire order */
+template<typename Order>
+inline void encodePixel(uint8_t *dst, const uint8_t (&lut)[3][256], uint8_t r, uint8_t g, uint8_t b)
+{
+  dst[Order::r] = lut[0][r];
+  dst[Order::g] = lut[1][g];
+  dst[Order::b] = lut[2][b];
+}
 
-  clearStrip(pxGyro);
-  clearStrip(pxTurn);
-  clearStrip(pxMain);
+class PixelBuffer {
+public:
+  PixelBuffer(uint16_t n, WhiteBalance wb) : n(n), wb(wb) { setBrightness(255); }
 
-  if (!cap.begin(0x5A))
+  static constexpr uint32_t Color(uint8_t r, uint8_t g, uint8_t b)
   {
-    Serial.println(F("MPR121 not found – check wiring!"));
-    while (true) ;
+    return uint32_t(r) << 16 | uint32_t(g) << 8 | b;
   }
-}
+  uint16_t numPixels() const { return n; }
+  const uint8_t *getPixels() const { return wire; }
+  const WhiteBalance &whiteBalance() const { return wb; }
 
-/* ---------------------------------------------------------------------------
- *  LOOP
- * ------------------------------------------------------------------------ */
-void loop()
-{
-  uint16_t touchNow = cap.touched();
-  if (touchNow) {
-    Serial.print(F("Touch 0x"));
-    Serial.print(touchNow, HEX);
-    Serial.println(F(" detected"));
+  void setPixelColor(uint16_t i, uint32_t c) { setPixelColor(i, c >> 16, c >> 8, c); }
+  void setPixelColor(uint16_t i, uint8_t r, uint8_t g, uint8_t b)
+  {
+    if (i < n) encodePixel<LedOrder>(wire + 3 * i, lut, r, g, b);
+  }
+  /* Levels already through gamma, balance and brightness: no table */
+  void setPixelLevels(uint16_t i, uint8_t r, uint8_t g, uint8_t b)
+  {
+    if (i >= n) return;
+    wire[3 * i + LedOrder::r] = r;
+    wire[3 * i + LedOrder::g] = g;
+    wire[3 * i + LedOrder::b] = b;
   }
 
-  /* -----------------------------------------------------------------------
-   *  GYRO BEACON  ──────────────────────────────────────────────────────────
-   * -------------------------------------------------------------------- */
-  handleTap(touchNow, TK_GYRO, tapGyro, cfgGyroBrightness, gyroEnabled,
-            tLastGyro, HP_GYRO,
-            [](){                 // on-toggle
-              gyroEnabled = !gyroEnabled;
-              tLastGyro   = millis() - HP_GYRO;   // sync phase
-              if (gyroEnabled)
-                toggleGyro(true, colGyroA, colGyroB);
-              else
-                clearStrip(pxGyro);
-            },
-            [](){                 // brightness-config loop
-              cfgGyroBrightness = true;
-              while (cfgGyroBrightness) {
-                int raw  = analogRead(POT_PIN);
-                uint8_t br = potToBrightness(raw);
-                pxGyro.setBrightness(br);
-                toggleGyro(true, colGyroA, colGyroB);
+  /* gamma(v) · gain · (b + 1), as 8-bit products like the Adafruit scaling */
+  void setBrightness(uint8_t b)
+  {
+    const uint8_t gain[3] = { wb.r, wb.g, wb.b };
+    for (uint8_t ch = 0; ch < 3; ++ch)
+      for (uint16_t v = 0; v < 256; ++v)
+        lut[ch][v] = uint32_t(GAMMA8.v[v]) * (gain[ch] + 1) * (b + 1) >> 16;
+  }
 
-                if (cap.touched() == TK_CTRL) {
-                  brGyroInit = br;
-                  waitRelease(5);
-                  cfgGyroBrightness = false;
-                  gyroEnabled = false;
-                  clearStrip(pxGyro);
-                }
-                if (cap.touched() == TK_GYRO) {
-                  pxGyro.setBrightness(brGyroInit);
-                  waitRelease(0);
-                  cfgGyroBrightness = false;
-                  gyroEnabled = false;
-                  clearStrip(pxGyro);
-                }
-              }
-            });
+protected:
+  uint16_t     n;
+  WhiteBalance wb;
+  uint8_t      lut[3][256];
+  uint8_t     *wire = own;                     // the frame on its way out
+  alignas(4) uint8_t own[3 * MAX_STRIP_PIXELS] = {};
+};
 
-  /* Half-period blinking while gyro is active */
-  if (gyroEnabled && millis() - tLastGyro >= HP_GYRO) {
-    tLastGyro += HP_GYRO;
-    static bool phase = false;
-    phase = !phase;
-    toggleGyro(phase, colGyroA, colGyroB);
-  }
+template<typename B, typename = void>
+struct IsLedBackend : std::false_type {};
+template<typename B>
+struct IsLedBackend<B, decltype(void(std::declval<B &>().begin()),
+                                void(std::declval<B &>().write(std::declval<const uint8_t *>(),
+                                                               uint16_t())),
+                                void(static_cast<uint8_t *>(std::declval<B &>().frame())))>
+  : std::is_constructible<B, uint8_t, uint16_t> {};
 
-  /* Colour swap: CTRL + GYRO (white ↔ red for the first 4 pixels) */
-  if (touchNow == TK_CTRL | TK_GYRO) {
-    while (cap.touched() == (TK_CTRL | TK_GYRO)) delay(10);
-    colGyroA = (colGyroA == pxGyro.Color(255,255,255)) ?
-               pxGyro.Color(255,0,0) : pxGyro.Color(255,255,255);
+template<typename Backend>
+class LedStrip : public PixelBuffer {
+  static_assert(IsLedBackend<Backend>::value,
+                "backend needs Backend(pin, n), begin(), frame() and write(const uint8_t *, uint16_t)");
+public:
+  LedStrip(uint16_t n, uint8_t pin, WhiteBalance wb) : PixelBuffer(n, wb), out(pin, n)
+  {
+    if (uint8_t *f = out.frame()) wire = f;
   }
+  void     begin()   { out.begin(); }
+  void     show()    { out.write(wire, 3 * n); }
+  Backend &backend() { return out; }
+private:
+  Backend out;
+};
 
-  /* -----------------------------------------------------------------------
-   *  TURN SIGNALS  (RIGHT / LEFT / HAZARD)
-   * -------------------------------------------------------------------- */
-  handleTap(touchNow, TK_TURN_R, tapTurnR, cfgTurnBrightness, turnR_Enabled,
-            tLastTurnR, HP_TURN,
-            [](){                                  // toggle right
-              turnR_Enabled = !turnR_Enabled;
-              tLastTurnR    = millis() - HP_TURN;
-              if (turnR_Enabled)  toggleTurnR(true, colTurnInit);
-              else                clearStrip(pxTurn);
-              turnL_Enabled   = false;
-              hazardEnabled   = false;
-            },
-            [](){                                  // brightness setup
-              cfgTurnBrightness = true;
-              while (cfgTurnBrightness) {
-                int raw  = analogRead(POT_PIN);
-                uint8_t br = potToBrightness(raw);
-                pxTurn.setBrightness(br);
-                toggleHazard(true, colTurnInit);
-
-                if (cap.touched() == TK_CTRL) {
-                  brTurnInit = br;
-                  waitRelease(5);
-                  cfgTurnBrightness = false;
-                  clearStrip(pxTurn);
-                }
-                if (cap.touched() & TK_HAZARD) {
-                  pxTurn.setBrightness(brTurnInit);
-                  waitRelease(1);  // either electrode 1 or 2 is fine
-                  cfgTurnBrightness = false;
-                  clearStrip(pxTurn);
-                }
-              }
-            });
+template<uint8_t Kind> struct LedBackendOf;
 
-  /* Blink right */
-  if (turnR_Enabled && millis() - tLastTurnR >= HP_TURN && !turnL_Enabled) {
-    tLastTurnR += HP_TURN;
-    static bool phaseR = false;
-    phaseR = !phaseR;
-    toggleTurnR(phaseR, colTurnInit);
+#if LED_USES(LED_OUT_NEOPIXEL)
+/* The library's own output for the board; it gets the frame pre-scaled */
+struct NeoPixelBackend {
+  Adafruit_NeoPixel px;
+  NeoPixelBackend(uint8_t pin, uint16_t n) : px(n, pin, NEO_GRB + NEO_KHZ800) {}
+  void     begin() { px.begin(); }
+  uint8_t *frame() { return px.getPixels(); }  // encoded in place, sent as is
+  void     write(const uint8_t *w, uint16_t bytes)
+  {
+    if (w != px.getPixels()) memcpy(px.getPixels(), w, bytes);
+    px.show();
   }
+};
+template<> struct LedBackendOf<LED_OUT_NEOPIXEL> { using type = NeoPixelBackend; };
+#endif
 
-  /* ─────────────────────────────────────────────────────────────────---- */
-  handleTap(touchNow, TK_TURN_L, tapTurnL, cfgTurnBrightness, turnL_Enabled,
-            tLastTurnL, HP_TURN,
-            [](){                                  // toggle left
-              turnL_Enabled = !turnL_Enabled;
-              tLastTurnL    = millis() - HP_TURN;
-              if (turnL_Enabled)  toggleTurnL(true, colTurnInit);
-              else                clearStrip(pxTurn);
-              turnR_Enabled   = false;
-              hazardEnabled   = false;
-            },
-            [](){});   // brightness config handled above – skip here
+#if LED_USES(LED_OUT_RMT)
+/* ESP32 RMT, 25 ns ticks; channels are handed out in begin() order.  The
+   driver reads the wire bytes itself and expands them to bit items in its
+   refill interrupt, a block at a time. */
+constexpr uint8_t RMT_TICK_NS = 25;            // 80 MHz APB / 2
+constexpr rmt_item32_t rmtBit(uint16_t hiNs, uint16_t loNs)
+{
+  rmt_item32_t it = {};
+  it.duration0 = hiNs / RMT_TICK_NS; it.level0 = 1;
+  it.duration1 = loNs / RMT_TICK_NS; it.level1 = 0;
+  return it;
+}
+constexpr uint32_t rmtPs(uint16_t ticks) { return uint32_t(ticks) * RMT_TICK_NS * 1000; }
 
-  /* Blink left */
-  if (turnL_Enabled && millis() - tLastTurnL >= HP_TURN) {
-    tLastTurnL += HP_TURN;
-    static bool phaseL = false;
-    phaseL = !phaseL;
-    toggleTurnL(phaseL, colTurnInit);
+struct RmtBackend {
+  static constexpr rmt_item32_t BIT0 = rmtBit(LED_T0H_NS, LED_T0L_NS);
+  static constexpr rmt_item32_t BIT1 = rmtBit(LED_T1H_NS, LED_T1L_NS);
+  static_assert(inWindow(rmtPs(BIT0.duration0), SK_T0H) && inWindow(rmtPs(BIT0.duration1), SK_T0L) &&
+                inWindow(rmtPs(BIT1.duration0), SK_T1H) && inWindow(rmtPs(BIT1.duration1), SK_T1L) &&
+                inWindow(rmtPs(BIT0.duration0 + BIT0.duration1), SK_BIT) &&
+                inWindow(rmtPs(BIT1.duration0 + BIT1.duration1), SK_BIT),
+                "RMT bit timing outside the SK6812 windows");
+  inline static uint8_t nextChannel = 0;
+
+  static void IRAM_ATTR translate(const void *src, rmt_item32_t *dst, size_t srcSize,
+                                  size_t wanted, size_t *done, size_t *items)
+  {
+    const uint8_t *w = static_cast<const uint8_t *>(src);
+    size_t k = 0, it = 0;
+    for (; k < srcSize && it + 8 <= wanted; ++k, it += 8)
+      for (uint8_t m = 0x80; m; m >>= 1) *dst++ = w[k] & m ? BIT1 : BIT0;
+    *done  = k;
+    *items = it;
   }
 
-  /* ─────────────────────────────────────────────────────────────────---- */
-  /* Hazard (both turn buttons together) */
-  if (touchNow == TK_HAZARD) {
-    hazardEnabled = !hazardEnabled;
-    tLastHazard   = millis() - HP_TURN;
-    if (hazardEnabled)  toggleHazard(true, colTurnInit);
-    else                clearStrip(pxTurn);
-    turnL_Enabled = turnR_Enabled = false;
-    waitRelease(1);   // wait until both electrodes are clear
+  uint8_t       pin;
+  rmt_channel_t ch    = RMT_CHANNEL_0;
+  unsigned long tDone = 0;                     // micros() at the end of the last frame
+
+  RmtBackend(uint8_t pin, uint16_t) : pin(pin) {}
+  void begin()
+  {
+    ch = rmt_channel_t(nextChannel++);
+    rmt_config_t cfg = RMT_DEFAULT_CONFIG_TX(gpio_num_t(pin), ch);
+    cfg.clk_div = 2;
+    rmt_config(&cfg);
+    rmt_driver_install(ch, 0, 0);
+    rmt_translator_init(ch, translate);
   }
-  if (hazardEnabled && millis() - tLastHazard >= HP_TURN) {
-    tLastHazard += HP_TURN;
-    static bool phaseH = false;
-    phaseH = !phaseH;
-    toggleHazard(phaseH, colTurnInit);
+  uint8_t *frame() { return nullptr; }
+  void write(const uint8_t *w, uint16_t bytes)
+  {
+    while (micros() - tDone < LED_RESET_US) {}
+    rmt_write_sample(ch, w, bytes, true);
+    tDone = micros();
   }
+};
+template<> struct LedBackendOf<LED_OUT_RMT> { using type = RmtBackend; };
+#endif
 
-  /* -----------------------------------------------------------------------
-   *  HEAD- / TAIL-LIGHTS
-   * -------------------------------------------------------------------- */
-  handleTap(touchNow, TK_HEAD, tapMain, cfgMainBrightness, headEnabled,
-            /* timer not needed */ tLastGyro, HP_TURN,
-            [](){                                   // toggle headlights
-              lowBeamEnabled = false;
-              headEnabled = !headEnabled;
-              if (headEnabled) toggleHead(true,  colHeadInit);
-              else             clearStrip(pxMain);
-            },
-            [](){                                   // brightness setup
-              cfgMainBrightness = true;
-              toggleHead(true, colHeadInit);
-              toggleTail(true, colTailInit);
-              while (cfgMainBrightness) {
-                int raw  = analogRead(POT_PIN);
-                uint8_t br = potToBrightness(raw);
-                pxMain.setBrightness(br);
-
-                if (cap.touched() == TK_CTRL) {
-                  brMainInit = br;
-                  waitRelease(5);
-                  cfgMainBrightness = false;
-                  clearStrip(pxMain);
-                  headEnabled = tailEnabled = false;
-                }
-                if (cap.touched() == TK_HEAD) {
-                  pxMain.setBrightness(brMainInit);
-                  waitRelease(3);
-                  cfgMainBrightness = false;
-                  clearStrip(pxMain);
-                  headEnabled = tailEnabled = false;
-                }
-              }
-            });
+#if LED_USES(LED_OUT_SPI)
+/* SPI MOSI as a waveform generator: every LED bit becomes a symbol of Bits
+   SPI bits, a 0 one high bit then low, a 1 two high bits.  A 256-entry
+   table turns a wire byte into its Bits symbol bytes; the DMA transfer is
+   queued and runs while the caller goes on, the next write() collects it. */
+template<uint8_t Bits, uint32_t Hz>
+struct SpiBackend {
+  static constexpr uint64_t SYM_PS = 1000000000000ULL / Hz;
+  static_assert(Bits == 3 || Bits == 4, "3- or 4-bit symbols");
+  static_assert(inWindow(SYM_PS,                  SK_T0H) && inWindow((Bits - 1) * SYM_PS, SK_T0L) &&
+                inWindow(2 * SYM_PS,              SK_T1H) && inWindow((Bits - 2) * SYM_PS, SK_T1L) &&
+                inWindow(Bits * SYM_PS,           SK_BIT),
+                "SPI symbol timing outside the SK6812 windows");
 
-  /* Tail lights (simple ON/OFF) */
-  if (touchNow == TK_TAIL) {
-    tailEnabled = !tailEnabled;
-    toggleTail(tailEnabled, colTailInit);
-    waitRelease(4);
+  struct Table { uint8_t sym[256][Bits]; };
+  static constexpr Table makeTable()
+  {
+    Table t = {};
+    for (uint16_t v = 0; v < 256; ++v) {
+      uint32_t bits = 0;                       // 8 × Bits, MSB first
+      for (uint8_t m = 0x80; m; m >>= 1)
+        bits = bits << Bits | (v & m ? 0b11u : 0b1u) << (Bits - 2 + !(v & m));
+      for (uint8_t k = 0; k < Bits; ++k) t.sym[v][k] = bits >> (8 * (Bits - 1 - k));
+    }
+    return t;
   }
+  static constexpr Table TABLE = makeTable();
+  inline static uint8_t nextHost = 0;
 
-  /* Low beam (head + tail together) */
-  if (touchNow == TK_LOW_BEAM) {
-    lowBeamEnabled = !lowBeamEnabled;
-    toggleLowBeam(lowBeamEnabled, colHeadInit);
-    waitRelease(3);   // release both 3 & 4
+  static void encode(uint8_t *dst, const uint8_t *w, uint16_t bytes)
+  {
+    for (uint16_t k = 0; k < bytes; ++k, dst += Bits) memcpy(dst, TABLE.sym[w[k]], Bits);
   }
 
-  /* -----------------------------------------------------------------------
-   *  COLOUR CONFIGURATION LOOPS
-   * -------------------------------------------------------------------- */
-  if (touchNow == TK_HEAD_COL) {
-    cfgColour = true;
-    while (cfgColour) {
-      int raw  = analogRead(POT_PIN);
-      uint32_t c = potToWhiteShade(raw);
-      toggleHead(true, c);
+  uint8_t             pin;
+  uint16_t            n;
+  uint8_t            *buf  = nullptr;          // DMA-capable, lead-in zero byte first
+  spi_device_handle_t dev  = nullptr;
+  spi_transaction_t   tr   = {};
+  bool                busy = false;
+  unsigned long       tEnd = 0;                // micros() when the last frame ends
 
-      if (cap.touched() == TK_CTRL) {
-        colHeadInit = c;
-        waitRelease(5);
-        cfgColour = false;
-        clearStrip(pxMain);
-      }
-      if (cap.touched() == TK_HEAD) {
-        waitRelease(3);
-        cfgColour = false;
-        clearStrip(pxMain);
-      }
+  SpiBackend(uint8_t pin, uint16_t n) : pin(pin), n(n) {}
+  uint8_t *frame() { return nullptr; }         // symbols need their own buffer
+  void begin()
+  {
+    spi_host_device_t host = nextHost++ ? SPI3_HOST : SPI2_HOST;
+    size_t            len  = 1 + 3 * n * Bits;
+    spi_bus_config_t  bus  = {};
+    bus.mosi_io_num     = pin;
+    bus.miso_io_num     = -1;
+    bus.sclk_io_num     = -1;
+    bus.quadwp_io_num   = -1;
+    bus.quadhd_io_num   = -1;
+    bus.max_transfer_sz = len;
+    spi_device_interface_config_t cfg = {};
+    cfg.clock_speed_hz = Hz;
+    cfg.spics_io_num   = -1;
+    cfg.queue_size     = 1;
+    buf = static_cast<uint8_t *>(heap_caps_malloc(len, MALLOC_CAP_DMA));
+    if (!buf || spi_bus_initialize(host, &bus, SPI_DMA_CH_AUTO) ||
+        spi_bus_add_device(host, &cfg, &dev)) dev = nullptr;
+  }
+  void write(const uint8_t *w, uint16_t bytes)
+  {
+    if (!dev) return;
+    if (busy) {                                // buffer is free once the DMA is done
+      spi_transaction_t *done;
+      spi_device_get_trans_result(dev, &done, portMAX_DELAY);
+      busy = false;
     }
+    buf[0] = 0;
+    encode(buf + 1, w, bytes);
+    while (long(micros() - tEnd) < long(LED_RESET_US)) {}
+    tr.length    = (1 + bytes * Bits) * 8;
+    tr.tx_buffer = buf;
+    busy = spi_device_queue_trans(dev, &tr, portMAX_DELAY) == 0;
+    tEnd = micros() + uint32_t(tr.length * SYM_PS / 1000000);
   }
+};
+template<> struct LedBackendOf<LED_OUT_SPI> { using type = SpiBackend<SPI_LED_BITS, SPI_LED_HZ>; };
+#endif
 
-  if (touchNow == TK_TAIL_COL) {
-    cfgColour = true;
-    while (cfgColour) {
-      int raw  = analogRead(POT_PIN);
-      uint32_t c = potToRedShade(raw);
-      toggleTail(true, c);
-
-      if (cap.touched() == TK_CTRL) {
-        colTailInit = c;
-        waitRelease(5);
-        cfgColour = false;
-        clearStrip(pxMain);
-      }
-      if (cap.touched() == TK_TAIL) {
-        waitRelease(4);
-        cfgColour = false;
-        clearStrip(pxMain);
-      }
-    }
+/* Last frame and a frame count, for host runs.  write() takes as long as a
+   blocking show() on the wire, so host timings include the transmit. */
+struct MockBackend {
+  uint8_t  wire[3 * MAX_STRIP_PIXELS] = {};
+  uint16_t bytes  = 0;
+  uint32_t frames = 0;
+  MockBackend(uint8_t, uint16_t) {}
+  void     begin() {}
+  uint8_t *frame() { return nullptr; }
+  void write(const uint8_t *w, uint16_t n)
+  {
+    memcpy(wire, w, n);
+    bytes = n;
+    frames++;
+    delayMicroseconds(uint32_t(n) * 8 * (LED_T0H_NS + LED_T0L_NS) / 1000);
   }
+};
+template<> struct LedBackendOf<LED_OUT_MOCK> { using type = MockBackend; };
 
-  /* -----------------------------------------------------------------------
-   *  DEMO “SHOW MODE”
-   * -------------------------------------------------------------------- */
-  if (touchNow == TK_SHOW) {
-    waitRelease(6);                 // debouncing
-    demoShowMode();
+#if LED_USES(LED_OUT_RECORDER)
+/* One line per frame: micros, pin, wire bytes in hex – for offline checks */
+struct RecorderBackend {
+  inline static FILE *file = nullptr;          // shared by all strips
+  uint8_t pin;
+  RecorderBackend(uint8_t pin, uint16_t) : pin(pin) {}
+  void     begin() { if (!file) file = fopen(LED_RECORD_PATH, "w"); }
+  uint8_t *frame() { return nullptr; }
+  void write(const uint8_t *w, uint16_t n)
+  {
+    if (!file) return;
+    fprintf(file, "%lu %u", (unsigned long)micros(), pin);
+    for (uint16_t k = 0; k < n; ++k) fprintf(file, " %02x", w[k]);
+    fputc('\n', file);
   }
-}
+};
+template<> struct LedBackendOf<LED_OUT_RECORDER> { using type = RecorderBackend; };
+#endif
 
-/* ===========================================================================
- *  HELPER FUNCTIONS
- * ======================================================================== */
 /* ---------------------------------------------------------------------------
- *  handleTap()
- *  ----------
- *  Generic double-tap detector + dispatcher.
+ *  Objects
  * ------------------------------------------------------------------------ */
-template<typename ToggleFn, typename CfgFn>
-void handleTap(uint16_t touchNow,
-               uint16_t keyMask,
-               TapTimer &tap,
-               bool &cfgFlag,
-               bool &featureFlag,
-               unsigned long &tLast,
-               uint16_t halfPeriod,
-               ToggleFn onToggle,
-               CfgFn    onConfig)
-{
-  /* flush stale taps (>1 s) */
-  if (tap.count && millis() - tap.first > 1000) tap.count = 0;
+LedStrip<LedBackendOf<LED_OUT_GYRO>::type> pxGyro (NUM_GYRO_PIXELS,     PIN_GYRO,      WB_GYRO);
+LedStrip<LedBackendOf<LED_OUT_TURN>::type> pxTurn (NUM_TURN_PIXELS,     PIN_TURN,      WB_TURN);
+LedStrip<LedBackendOf<LED_OUT_MAIN>::type> pxMain (NUM_HEADTAIL_PIXELS, PIN_HEAD_TAIL, WB_MAIN);
 
-  if (touchNow == keyMask) {            // electrode touched
-    tap.count++;
-    if (tap.count == 1) tap.first = millis();
+Adafruit_MPR121   cap[NUM_TOUCH_SENSORS];
 
-    /* Double-tap → config loop */
-    if (tap.count == 2 && millis() - tap.first < 500) {
-      tap.count = 0;
-      cfgFlag   = true;
-      onConfig();
-      return;
-    }
+enum StripId : uint8_t { STRIP_GYRO, STRIP_TURN, STRIP_MAIN, NUM_STRIPS };
+PixelBuffer *const strips[NUM_STRIPS] = { &pxGyro, &pxTurn, &pxMain };
 
-    /* Single tap → ON / OFF */
-    if (tap.count == 1) {
-      onToggle();
-    }
-    waitRelease(__builtin_ctz(keyMask));   // wait for release of that electrode
+/* Transmit through the strip's own backend type – a switch, no vtable */
+inline void stripTransmit(StripId s)
+{
+  switch (s) {
+    case STRIP_GYRO: pxGyro.show(); break;
+    case STRIP_TURN: pxTurn.show(); break;
+    default:         pxMain.show(); break;
   }
-
-  /* Blinking handled outside */
 }
 
 /* ---------------------------------------------------------------------------
- *  Strip helpers
+ *  Output stage
+ *  ------------
+ *  Everything reaches the LEDs through stripSet() / stripBrightness() /
+ *  stripShow().  Normally these are the PixelBuffer calls.  With LED_DITHER the
+ *  whole encode is done here instead: each channel is kept as the 8.8 product
+ *  gamma(colour) × white balance × (brightness + 1), and stripShow() quantises
+ *  it to 8 bits carrying the dropped fraction into the next frame, per pixel
+ *  and channel, and stores the result past the PixelBuffer table.
+ *  Strips with a fraction left are re-sent every DITHER_FRAME_US, so a level
+ *  between two 8-bit steps averages out instead of showing the step.
+ *  With LAMP_MODEL the LAMP_PX pixels (turn signals, tail) do not follow
+ *  that value directly but a first-order filament response to it, faster
+ *  heating than cooling, stepped in Q15 on every transmit; while one is
+ *  still settling its strip is re-sent every LAMP_FRAME_US.
  * ------------------------------------------------------------------------ */
-void clearStrip(Adafruit_NeoPixel &strip)
-{
-  for (uint16_t i = 0; i < strip.numPixels(); ++i)
-    strip.setPixelColor(i, 0);
-  strip.show();
-}
+constexpr uint8_t LAMP_PX[NUM_STRIPS] = { 0, 0x0F, _BV(1) | _BV(6) };   // bulbs per strip
 
-void toggleGyro(bool phase, uint32_t c1, uint32_t c2)
+#if LED_SHADOW
+struct OutputStrip {
+  uint32_t      colour[MAX_STRIP_PIXELS]  = {};  // as painted, 0x00RRGGBB
+  uint16_t      lin[MAX_STRIP_PIXELS][3]  = {};  // gamma × balance × (brightness + 1), 8.8
+  uint8_t       err[MAX_STRIP_PIXELS][3]  = {};  // dither fraction carried over
+  uint16_t      lamp[MAX_STRIP_PIXELS][3] = {};  // filament output, scale of lin
+  uint8_t       br       = 255;
+  bool          frac     = false;                // some channel between steps
+  bool          settling = false;                // some filament still moving
+  unsigned long tSent    = 0;                    // micros()
+};
+OutputStrip outStage[NUM_STRIPS];
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  Feature state word
+ *  ------------------
+ *  Every feature / config flag lives in one atomic word, so an ISR, the other
+ *  core or a telemetry task gets a consistent snapshot with a single load and
+ *  each transition is a single compare-and-swap.
+ * ------------------------------------------------------------------------ */
+constexpr uint32_t ST_GYRO          = _BV(0);
+constexpr uint32_t ST_TURN_R        = _BV(1);
+constexpr uint32_t ST_TURN_L        = _BV(2);
+constexpr uint32_t ST_HAZARD        = _BV(3);
+constexpr uint32_t ST_HEAD          = _BV(4);
+constexpr uint32_t ST_TAIL          = _BV(5);
+constexpr uint32_t ST_LOW_BEAM      = _BV(6);
+constexpr uint32_t ST_SHOW          = _BV(7);
+
+constexpr uint32_t ST_CFG_GYRO_BR   = _BV(8);
+constexpr uint32_t ST_CFG_TURN_BR   = _BV(9);
+constexpr uint32_t ST_CFG_MAIN_BR   = _BV(10);
+constexpr uint32_t ST_CFG_HEAD_COL  = _BV(11);
+constexpr uint32_t ST_CFG_TAIL_COL  = _BV(12);
+constexpr uint32_t ST_CFG_COLOUR    = ST_CFG_HEAD_COL | ST_CFG_TAIL_COL;
+constexpr uint32_t ST_RAINBOW       = _BV(13);
+constexpr uint32_t ST_EFFECTS       = ST_SHOW | ST_RAINBOW;   // script-driven, exclusive
+
+std::atomic<uint32_t> gState{0};
+
+inline uint32_t stateSnapshot()          { return gState.load(std::memory_order_acquire); }
+inline bool     stateTest(uint32_t bits) { return (stateSnapshot() & bits) != 0; }
+
+/* Clear `clr`, then flip `flip`, then set `set` – all in one CAS.
+ * Returns the word that was published. */
+uint32_t stateUpdate(uint32_t clr, uint32_t flip, uint32_t set)
 {
-  /* Two interleaved groups of four pixels */
-  for (uint8_t i = 0; i < 8; ++i) {
-    bool groupA = (i < 2) || (i > 5);
-    pxGyro.setPixelColor(i, phase ^ groupA ? c1 : c2);
-  }
-  pxGyro.show();
+  uint32_t cur = gState.load(std::memory_order_relaxed);
+  uint32_t next;
+  do {
+    next = ((cur & ~clr) ^ flip) | set;
+  } while (!gState.compare_exchange_weak(cur, next,
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_relaxed));
+  return next;
 }
+inline uint32_t stateSet   (uint32_t bits)                  { return stateUpdate(0,    0,   bits); }
+inline uint32_t stateClear (uint32_t bits)                  { return stateUpdate(bits, 0,   0);    }
+inline uint32_t stateToggle(uint32_t bit, uint32_t clr = 0) { return stateUpdate(clr,  bit, 0);    }
 
-void toggleTurnR(bool phase, uint32_t c)
+/* ---------------------------------------------------------------------------
+ *  Tempo clock
+ *  -----------
+ *  Every periodic effect runs on tempo time, which advances TEMPO_BEAT_MS
+ *  per beat of the tapped tempo.  A tempo change only changes the rate from
+ *  the current point on, so nothing jumps; lining the beat up with the taps
+ *  is spread out as a bounded speed-up / slow-down (slew) that never runs
+ *  tempo time backwards.  Each tick is a multiply, a division by a constant
+ *  and a few adds; the tempo division happens once per tap.
+ * ------------------------------------------------------------------------ */
+struct TempoClock {
+  unsigned long tReal  = 0;                    // real µs of the last tick
+  unsigned long tt     = 0;                    // tempo ms at tReal
+  uint32_t      frac   = 0;                    // sub-ms of tt, tempo µs in Q16
+  uint32_t      rate   = 65536;                // tempo per real time, Q16
+  int64_t       slew   = 0;                    // phase correction left, tempo µs in Q16
+};
+TempoClock tempo;
+
+struct TapTempo {
+  unsigned long tLast = 0;
+  uint16_t      interval[TAP_HISTORY] = {};
+  uint8_t       n     = 0;                     // taps in this count, capped below 2·TAP_HISTORY + 1
+};
+TapTempo tapTempo;
+
+unsigned long tempoTick(unsigned long nowUs);
+unsigned long tempoNow();
+unsigned long tempoBeat();
+void          tempoSet(uint16_t beatMs);
+void          tempoTap(unsigned long tPress);
+
+/* ---------------------------------------------------------------------------
+ *  Lamp arbiter
+ *  ------------
+ *  The strips are split into lamp groups.  While its state bit is set, a
+ *  feature claims its groups at its own priority (the Feature value, higher
+ *  wins): hazard over turn, config preview over normal lamps, show mode over
+ *  everything.  compose() resolves every group's owner once per frame and
+ *  repaints only groups whose owner, blink phase or brightness changed, then
+ *  shows each touched strip once.  Show mode paints through its scripts.
+ * ------------------------------------------------------------------------ */
+enum LampGroup : uint8_t { GRP_GYRO, GRP_TURN_L, GRP_TURN_R, GRP_HEAD, GRP_TAIL, NUM_GROUPS };
+
+enum Feature : uint8_t {                       // ascending priority
+  FT_LOW_BEAM, FT_HEAD, FT_TAIL, FT_GYRO,
+  FT_TURN_R, FT_TURN_L, FT_HAZARD,
+  FT_PREVIEW, FT_SHOW,
+  FT_NONE = 0x7F
+};
+
+struct LampGroupMap {
+  StripId strip;
+  uint8_t count;
+  uint8_t px[MAX_STRIP_PIXELS];
+};
+constexpr LampGroupMap GROUPS[NUM_GROUPS] = {
+  { STRIP_GYRO, 8, {0,1,2,3,4,5,6,7} },
+  { STRIP_TURN, 2, {1,0} },                    // turn groups listed inside out
+  { STRIP_TURN, 2, {2,3} },
+  { STRIP_MAIN, 6, {0,2,3,4,5,7} },
+  { STRIP_MAIN, 2, {1,6} },
+};
+constexpr uint8_t LOW_BEAM_PX = _BV(0) | _BV(2) | _BV(5) | _BV(7);
+
+/* A sweeping turn signal lights one more pixel of its group per frame */
+constexpr uint8_t SEQ_STEPS = GROUPS[GRP_TURN_R].count;
+static_assert(GROUPS[GRP_TURN_L].count == SEQ_STEPS, "both turn groups sweep in step");
+static_assert(2 * SEQ_STEPS == NUM_TURN_PIXELS, "the turn groups cover the turn strip");
+static_assert((SEQ_STEPS - 1) * SEQ_STEP_MS < HP_TURN, "the sweep must end inside the lit half");
+
+struct Claim {
+  uint32_t bits;                               // any of these set → claim
+  Feature  f;
+  uint8_t  groups;
+};
+constexpr uint8_t GRP_TURN = _BV(GRP_TURN_L) | _BV(GRP_TURN_R);
+constexpr uint8_t GRP_ALL  = _BV(NUM_GROUPS) - 1;
+const Claim CLAIMS[] = {
+  { ST_LOW_BEAM,     FT_LOW_BEAM, _BV(GRP_HEAD)                 },
+  { ST_HEAD,         FT_HEAD,     _BV(GRP_HEAD)                 },
+  { ST_TAIL,         FT_TAIL,     _BV(GRP_TAIL)                 },
+  { ST_GYRO,         FT_GYRO,     _BV(GRP_GYRO)                 },
+  { ST_TURN_R,       FT_TURN_R,   _BV(GRP_TURN_R)               },
+  { ST_TURN_L,       FT_TURN_L,   _BV(GRP_TURN_L)               },
+  { ST_HAZARD,       FT_HAZARD,   GRP_TURN                      },
+  { ST_CFG_GYRO_BR,  FT_PREVIEW,  _BV(GRP_GYRO)                 },
+  { ST_CFG_TURN_BR,  FT_PREVIEW,  GRP_TURN                      },
+  { ST_CFG_MAIN_BR,  FT_PREVIEW,  _BV(GRP_HEAD) | _BV(GRP_TAIL) },
+  { ST_CFG_HEAD_COL, FT_PREVIEW,  _BV(GRP_HEAD)                 },
+  { ST_CFG_TAIL_COL, FT_PREVIEW,  _BV(GRP_TAIL)                 },
+  { ST_EFFECTS,      FT_SHOW,     GRP_ALL                       },
+};
+
+/* ---------------------------------------------------------------------------
+ *  Flash patterns
+ *  --------------
+ *  Beacon-style patterns for the flashing feature of each strip (gyro beacon,
+ *  hazard, headlights), chosen per strip over Serial ("p<strip><pattern>").
+ *  A pattern is a table of one-byte steps – which halves of the strip are lit
+ *  (bits 7:6) for how many 10 ms (bits 5:0) – looped from the feature's time
+ *  origin.  Step edges come from the frame timer below, not from loop().
+ * ------------------------------------------------------------------------ */
+enum FlashPattern : uint8_t {
+  PAT_DEFAULT,                                 // the feature's own blink
+  PAT_SINGLE, PAT_DOUBLE, PAT_QUAD, PAT_WIGWAG, PAT_ALT_HALVES,
+  NUM_PATTERNS
+};
+
+constexpr uint8_t H_A  = 1;                    // lower pixel indices
+constexpr uint8_t H_B  = 2;
+constexpr uint8_t H_AB = H_A | H_B;
+
+template<uint8_t Halves, uint16_t Ms>
+constexpr uint8_t fs()
+{
+  static_assert(Halves <= H_AB,     "flash step halves are two bits");
+  static_assert(Ms / 10 <= 0x3F,    "flash step longer than 630 ms");
+  static_assert(Ms % 10 == 0,       "flash steps are whole 10 ms");
+  return Halves << 6 | Ms / 10;
+}
+constexpr uint16_t fsMs(uint8_t step)     { return (step & 0x3F) * 10; }
+constexpr uint8_t  fsHalves(uint8_t step) { return step >> 6; }
+
+constexpr uint8_t PAT_SINGLE_STEPS[]  = { fs<H_AB, 100>(), fs<0, 400>() };
+constexpr uint8_t PAT_DOUBLE_STEPS[]  = { fs<H_AB, 60>(), fs<0, 60>(), fs<H_AB, 60>(), fs<0, 320>() };
+constexpr uint8_t PAT_QUAD_STEPS[]    = { fs<H_AB, 40>(), fs<0, 40>(), fs<H_AB, 40>(), fs<0, 40>(),
+                                          fs<H_AB, 40>(), fs<0, 40>(), fs<H_AB, 40>(), fs<0, 220>() };
+constexpr uint8_t PAT_WIGWAG_STEPS[]  = { fs<H_A, 250>(), fs<H_B, 250>() };
+constexpr uint8_t PAT_ALT_STEPS[]     = { fs<H_A, 50>(), fs<0, 50>(), fs<H_A, 50>(), fs<0, 100>(),
+                                          fs<H_B, 50>(), fs<0, 50>(), fs<H_B, 50>(), fs<0, 100>() };
+
+struct FlashPatternDef {
+  const uint8_t *steps;
+  uint8_t        count;
+  uint16_t       cycleMs;
+};
+template<size_t N>
+constexpr FlashPatternDef flashPattern(const uint8_t (&steps)[N])
+{
+  uint16_t ms = 0;
+  for (size_t i = 0; i < N; ++i) ms += fsMs(steps[i]);
+  return { steps, uint8_t(N), ms };
+}
+const FlashPatternDef PATTERNS[NUM_PATTERNS] = {
+  { nullptr, 0, 0 },
+  flashPattern(PAT_SINGLE_STEPS), flashPattern(PAT_DOUBLE_STEPS),
+  flashPattern(PAT_QUAD_STEPS),   flashPattern(PAT_WIGWAG_STEPS),
+  flashPattern(PAT_ALT_STEPS),
+};
+
+constexpr uint8_t FRAME_PATTERN = 0x08;        // frame = FRAME_PATTERN | halves
+
+/* Time-driven owners make compose() schedule itself: on ESP32 a one-shot
+   esp_timer fires at the next frame edge, so blink and sweep steps land on
+   their microsecond even while loop() is blocked in a config loop. */
+constexpr long NO_DEADLINE = 0x7FFFFFFF;
+
+/* One composed frame: the colour of every group pixel and the key each
+   group was painted for.  The render path paints into its `px` through a
+   Canvas; only commitFrame() hands it to the output stage. */
+struct FrameImage {
+  unsigned long tt     = 0;                    // tempo ms the frame is due
+  uint8_t       groups = 0;                    // groups repainted for it
+  uint16_t      key[NUM_GROUPS] = {};          // owner << 4 | frame
+  uint32_t      px[NUM_STRIPS][MAX_STRIP_PIXELS] = {};
+};
+typedef uint32_t (*Canvas)[MAX_STRIP_PIXELS];  // nullptr = straight to the strips
+
+inline void canvasSet(Canvas to, StripId s, uint16_t i, uint32_t c);
+
+struct Compositor {
+  FrameImage    img;                           // what is on the strips
+  uint8_t       dirty           = GRP_ALL;     // repaint regardless of key
+  unsigned long tArmed          = 0;           // real µs the tempo reaches the next edge
+  bool          armed           = false;
+};
+Compositor comp;
+
+/* Run-ahead: after a commit compose() renders the next RUN_AHEAD frame
+   edges into a ring, so at an edge the output stage only copies the head
+   image out and transmits.  The frames are deterministic for one state
+   word, presets version and scene version (origins, patterns, colour); a
+   change of any, a new brightness or composeInvalidate() drops them and
+   the frame is rendered inline again. */
+#if RUN_AHEAD
+struct FrameRing {
+  FrameImage    f[RUN_AHEAD];
+  uint8_t       head    = 0;
+  uint8_t       count   = 0;
+  bool          open    = false;               // ttNext is an edge to render
+  unsigned long ttNext  = 0;
+  uint32_t      state   = 0;                   // what the frames are valid for
+  uint32_t      presets = 0;
+  uint32_t      scene   = 0;
+};
+FrameRing ring;
+#endif
+
+/* Commit lateness at frame edges, µs after the tempo edge, per render path */
+enum JitterPath : uint8_t { JIT_INLINE, JIT_AHEAD, NUM_JIT };
+struct CommitJitter {
+  uint32_t n     = 0;
+  int64_t  sumUs = 0;
+  long     minUs = 0x7FFFFFFF;
+  long     maxUs = -0x7FFFFFFF;
+};
+CommitJitter jitter[NUM_JIT];
+
+#if defined(ESP32)
+SemaphoreHandle_t  frameLock  = nullptr;       // compositor + output stage
+esp_timer_handle_t frameTimer = nullptr;
+struct FrameGuard {
+  FrameGuard()  { xSemaphoreTakeRecursive(frameLock, portMAX_DELAY); }
+  ~FrameGuard() { xSemaphoreGiveRecursive(frameLock); }
+};
+#else
+struct FrameGuard { ~FrameGuard() {} };         // single context, nothing to lock
+#endif
+
+/* Double-tap bookkeeping */
+struct TapTimer {
+  uint8_t       count  = 0;
+  unsigned long first  = 0;
+};
+TapTimer tapGyro, tapTurnR, tapTurnL, tapMain;
+
+/* ---------------------------------------------------------------------------
+ *  Chord resolver
+ *  --------------
+ *  Turns the raw electrode level into press events.  A key that could still
+ *  grow into a chord is held back for up to CHORD_SKEW_MS; if its partner
+ *  lands in time the chord is emitted, otherwise the held keys come out as
+ *  singles (one per call).  Emitted keys stay silent until released, so the
+ *  handlers no longer wait for release themselves.
+ * ------------------------------------------------------------------------ */
+struct ChordResolver {
+  TouchMask     held     = 0;                  // down, undecided
+  TouchMask     singles  = 0;                  // decided, not yet emitted
+  TouchMask     consumed = 0;                  // emitted, waiting for release
+  unsigned long tFirst   = 0;
+};
+ChordResolver chord;
+
+/* ---------------------------------------------------------------------------
+ *  Long-press brightness stepping
+ *  ------------------------------
+ *  Holding a lamp electrode past LONG_PRESS_MS steps that strip's brightness
+ *  with an accelerating repeat, bouncing at the ends; the direction flips
+ *  for the next hold.  A step only moves a level in the brightness stage;
+ *  brCommit() applies the dirty levels once per loop and has the compositor
+ *  repaint the strip, since a new level only reaches pixels set after it.
+ *  Release stores the level as preset.
+ * ------------------------------------------------------------------------ */
+struct BrightnessStage {
+  uint8_t level[NUM_STRIPS] = {};
+  uint8_t dirty             = 0;               // one bit per StripId
+};
+BrightnessStage brStage;
+
+struct LongPress {
+  TouchMask     key    = 0;                    // single lamp key being held
+  unsigned long tDown  = 0;
+  unsigned long tNext  = 0;
+  uint8_t       steps  = 0;
+  bool          active = false;
+};
+LongPress longPress;
+int8_t    brDir[NUM_STRIPS] = { 1, 1, 1 };
+
+inline StripId stripOfKey(TouchMask key)
+{
+  return key == TK_GYRO ? STRIP_GYRO : (key & TK_HAZARD) ? STRIP_TURN : STRIP_MAIN;
+}
+
+/* ---------------------------------------------------------------------------
+ *  Versioned<T> – single-writer sequence lock
+ *  ------------------------------------------
+ *  The one writer bumps the version to odd, edits, bumps it back to even.
+ *  The payload is published as words of relaxed atomics, so a reader racing
+ *  the writer sees torn words, never undefined behaviour, and retries if the
+ *  version was odd or moved underneath it.  `data` is the writer's own copy;
+ *  only the writer may read it directly.
+ * ------------------------------------------------------------------------ */
+template<typename T>
+struct Versioned {
+  static_assert(std::is_trivially_copyable<T>::value, "Versioned<T> copies T word-wise");
+  static constexpr size_t WORDS = (sizeof(T) + 3) / 4;
+
+  std::atomic<uint32_t> version{0};
+  std::atomic<uint32_t> words[WORDS] = {};
+  T                     data{};
+
+  Versioned() { publish(); }
+
+  template<typename Fn>
+  void write(Fn edit)
+  {
+    uint32_t v = version.load(std::memory_order_relaxed);
+    version.store(v + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    edit(data);
+    publish();
+    version.store(v + 2, std::memory_order_release);
+  }
+
+  T snapshot() const
+  {
+    uint32_t w[WORDS];
+    uint32_t v0, v1;
+    do {
+      v0 = version.load(std::memory_order_acquire);
+      for (size_t i = 0; i < WORDS; ++i) w[i] = words[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      v1 = version.load(std::memory_order_relaxed);
+    } while ((v0 & 1) || v0 != v1);
+    T copy;
+    memcpy(&copy, w, sizeof(T));
+    return copy;
+  }
+
+private:
+  void publish()
+  {
+    uint32_t w[WORDS] = {};
+    memcpy(w, &data, sizeof(T));
+    for (size_t i = 0; i < WORDS; ++i) words[i].store(w[i], std::memory_order_relaxed);
+  }
+};
+
+/* ---------------------------------------------------------------------------
+ *  User presets (will be updated from setup loops)
+ * ------------------------------------------------------------------------ */
+struct Presets {
+  uint8_t  brGyroInit   = 100;                                          // 0-255
+  uint8_t  brTurnInit   = 100;
+  uint8_t  brMainInit   = 100;
+
+  uint32_t colHeadInit  = PixelBuffer::Color(230, 240, 255);      // bluish-white
+  uint32_t colTailInit  = PixelBuffer::Color(255,   0,   0);      // red
+  uint32_t colTurnInit  = PixelBuffer::Color(255, 165,   0);      // amber
+  uint32_t colGyroA     = PixelBuffer::Color(255,   0,   0);      // red
+  uint32_t colGyroB     = PixelBuffer::Color(  0,   0, 255);      // blue
+};
+Versioned<Presets> gPresets;
+
+/* Loop-side view; other contexts must use gPresets.snapshot() */
+inline const Presets &preset() { return gPresets.data; }
+
+/* ---------------------------------------------------------------------------
+ *  Lamp scene
+ *  ----------
+ *  What loop() sets up for the compositor besides the state word.  compose()
+ *  also runs on the frame timer, so it reads a snapshot, never the fields.
+ * ------------------------------------------------------------------------ */
+struct LampScene {
+  /* Blink time origins, in tempo time and on the beat grid.  The phase is
+     derived from them, so a blinker that was preempted comes back in step
+     without being restarted.  Left, right and hazard share one origin and
+     therefore always blink together. */
+  unsigned long tOrgGyro   = 0;
+  unsigned long tOrgTurn   = 0;
+  unsigned long tOrgHead   = 0;                // only used by flash patterns
+  uint32_t      cfgColour  = 0;                // live colour of a colour config
+  uint8_t       pattern[NUM_STRIPS] = {};      // FlashPattern per StripId
+};
+Versioned<LampScene> gScene;
+
+/* Loop-side view; other contexts must use gScene.snapshot() */
+inline const LampScene &scene() { return gScene.data; }
+
+/* Restart a blink origin on the current beat.  The beat is read before the
+   write: tempoBeat() takes the frame lock, which compose() may hold while
+   it waits for the write to finish. */
+inline void originSync(unsigned long LampScene::*org)
+{
+  unsigned long t = tempoBeat();
+  gScene.write([org, t](LampScene &s){ s.*org = t; });
+}
+
+inline void turnSync()                         // before a turn feature starts
+{
+  if (!stateTest(ST_TURN_R | ST_TURN_L | ST_HAZARD)) originSync(&LampScene::tOrgTurn);
+}
+
+/* ---------------------------------------------------------------------------
+ *  Touch acquisition
+ *  -----------------
+ *  One auto-incrementing burst (0x00…0x2A) returns touch status, out-of-range
+ *  status, filtered data and baselines of all 13 channels.  On ESP32 a task on
+ *  the other core runs the burst every TOUCH_POLL_US and publishes it; the
+ *  loop only ever reads the latest sample and never touches the bus.
+ *  With several sensors, one pass bursts only those whose IRQ fired (or whose
+ *  data is older than TOUCH_REFRESH_MS) and publishes a single 48-bit mask.
+ * ------------------------------------------------------------------------ */
+constexpr uint8_t  MPR_TOUCH_STATUS = 0x00;
+constexpr uint8_t  MPR_OOR_STATUS   = 0x02;
+constexpr uint8_t  MPR_FILT_DATA    = 0x04;
+constexpr uint8_t  MPR_BASELINE     = 0x1E;
+constexpr uint8_t  MPR_BURST_LEN    = 0x2B;    // 43 bytes
+static_assert(TOUCH_BURST_BYTES == 3 + MPR_BURST_LEN, "TOUCH_POLL_US assumes this burst");
+
+constexpr uint8_t  NUM_CHANNELS     = 13;      // 12 electrodes + proximity
+constexpr uint16_t TOUCH_MASK_ALL   = 0x0FFF;
+
+struct TouchSample {
+  uint16_t      touched   = 0;                 // chip decision, bit 12 = proximity
+  uint16_t      oor       = 0;                 // out-of-range (auto-config failed)
+  uint16_t      filtered[NUM_CHANNELS] = {};   // 10-bit
+  uint16_t      baseline[NUM_CHANNELS] = {};   // 10-bit (register holds bits 9:2)
+  unsigned long tMicros   = 0;                 // start of the burst
+  uint16_t      busMicros = 0;                 // time the burst held the bus
+};
+Versioned<TouchSample> gTouch[NUM_TOUCH_SENSORS];
+std::atomic<TouchMask> gTouchMask{0};          // hot path: electrode bits only
+std::atomic<uint32_t>  gTouchIrq{(1U << NUM_TOUCH_SENSORS) - 1};   // sensors to poll
+
+/* ---------------------------------------------------------------------------
+ *  Software touch detection (TOUCH_SW_DETECT)
+ *  ------------------------------------------
+ *  Runs on every sample, in the acquisition context.  delta = baseline −
+ *  filtered; the touch threshold follows each electrode's own noise floor,
+ *  release sits at half of it, and an edge needs SW_DEBOUNCE samples in a row.
+ *  All integer; noise is kept in Q4.
+ * ------------------------------------------------------------------------ */
+constexpr uint8_t  SW_DEBOUNCE      = 2;       // samples (2 ms)
+constexpr uint8_t  SW_NOISE_GAIN    = 4;       // touch threshold = gain × noise
+constexpr uint8_t  SW_NOISE_SHIFT   = 4;       // noise EWMA: α = 1/16
+
+/* Threshold floor per electrode, in counts (chip default is 12 / 6) */
+constexpr uint8_t  SW_TOUCH_MIN[12] = { 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6 };
+
+struct SwDetector {
+  uint16_t noiseQ4  = 2 << 4;
+  uint8_t  count    = 0;
+  bool     down     = false;
+};
+SwDetector swDet[NUM_TOUCH_SENSORS][12];
+
+/* ---------------------------------------------------------------------------
+ *  Signal-quality analytics
+ *  ------------------------
+ *  Per electrode, updated on every sample in the acquisition context:
+ *  baseline drift and range since the sensor settled (baseline0 is the mean
+ *  of its first STATS_BASE_N touch-ready samples, not the power-on value the
+ *  chip is still learning from), noise (mean / variance of delta while released),
+ *  mean touch delta, and touch / release / bounce counts.  EWMAs with α = 1/64
+ *  in fixed point: mean in Q4 counts, variance in Q8 counts².
+ *  Serial 's' prints a table, 'r' resets it.
+ * ------------------------------------------------------------------------ */
+constexpr uint8_t  STATS_SHIFT      = 6;       // α = 1/64
+constexpr uint16_t BOUNCE_MS        = 60;      // re-touch sooner = bounce
+constexpr uint8_t  STATS_BASE_N     = 16;      // settled samples averaged into baseline0
+
+struct ElectrodeStats {
+  uint16_t baseline0   = 0;                    // 0 = not settled yet
+  uint16_t baseMin     = 0xFFFF;               // since baseline0
+  uint16_t baseMax     = 0;
+  int16_t  drift       = 0;                    // baseline − baseline0
+  uint16_t base0Sum    = 0;                    // 16 × 10 bits fits
+  uint8_t  base0N      = 0;
+  int32_t  noiseMeanQ4 = 0;
+  uint32_t noiseVarQ8  = 0;
+  int32_t  touchMeanQ4 = 0;
+  uint16_t touches     = 0;
+  uint16_t releases    = 0;
+  uint16_t bounces     = 0;
+  uint32_t tRelease    = 0;
+};
+ElectrodeStats stats[NUM_TOUCH_SENSORS][12];
+ElectrodeStats statsSnap[NUM_TOUCH_SENSORS][12];   // copy handed to the loop
+
+enum : uint8_t { STATS_IDLE, STATS_REQUESTED, STATS_READY, STATS_RESET };
+std::atomic<uint8_t> gStatsReq{STATS_IDLE};
+
+/* ---------------------------------------------------------------------------
+ *  Capacitive slider (INPUT_SLIDER)
+ *  --------------------------------
+ *  A row of electrodes read as one 0-4095 control, interpolated from the
+ *  peak electrode and its neighbours.  Updated on every sample; the last
+ *  position is held when the finger lifts, like a pot that stays put.
+ * ------------------------------------------------------------------------ */
+constexpr uint8_t  SLIDER_SENSOR    = 0;
+constexpr uint8_t  SLIDER_FIRST     = 7;       // electrodes 7…11, left → right
+constexpr uint8_t  SLIDER_COUNT     = 5;
+constexpr uint8_t  SLIDER_MIN_DELTA = 8;       // peak below this = no finger
+constexpr uint16_t SLIDER_MAX       = 4095;    // same scale as analogRead()
+
+constexpr uint16_t SLIDER_BITS      = ((1U << SLIDER_COUNT) - 1) << SLIDER_FIRST;
+
+static_assert(SLIDER_FIRST + SLIDER_COUNT <= 12, "slider must fit on one sensor");
+
+std::atomic<uint16_t> gSliderPos{0};
+
+/* ---------------------------------------------------------------------------
+ *  Low-power sleep
+ *  ---------------
+ *  After IDLE_SLEEP_MS without a touch and with nothing blinking, the strips
+ *  go dark, sensor 0 drops to proximity-only sensing (all 12 electrodes as
+ *  one, 128 ms sample interval) and the MCU deep-sleeps with that sensor's IRQ
+ *  line as wake source.  Steady lamps and presets survive in RTC memory and
+ *  are back on the strips before the sensors are re-initialised.  Before the
+ *  loop takes the bus, the touch task is asked to park itself between two
+ *  passes, so it never stops holding the Wire lock mid-transfer.
+ * ------------------------------------------------------------------------ */
+constexpr uint8_t  MPR_PROX_TTH     = 0x59;
+constexpr uint8_t  MPR_PROX_RTH     = 0x5A;
+constexpr uint8_t  MPR_CONFIG2      = 0x5D;
+constexpr uint8_t  MPR_ECR          = 0x5E;
+constexpr uint8_t  CONFIG2_SLEEP    = 0x27;    // 0.5 µs CDT, 4 samples, ESI 128 ms
+constexpr uint8_t  ECR_STOP         = 0x00;
+constexpr uint8_t  ECR_PROX_ONLY    = 0xB0;    // CL=10, ELEPROX = ELE0-11, ELE off
+
+constexpr uint32_t SLEEP_KEEP       = ST_HEAD | ST_TAIL | ST_LOW_BEAM;
+constexpr uint32_t SLEEP_BLOCK      = ST_GYRO | ST_TURN_R | ST_TURN_L | ST_HAZARD | ST_EFFECTS |
+                                      ST_CFG_GYRO_BR | ST_CFG_TURN_BR |
+                                      ST_CFG_MAIN_BR | ST_CFG_COLOUR;
+constexpr uint32_t RTC_MAGIC        = 0x504C5331;    // "PLS1"
+
+/* Plain storage: anything with a constructor would be re-initialised on wake */
+RTC_DATA_ATTR uint32_t rtcMagic;
+RTC_DATA_ATTR uint32_t rtcState;
+RTC_DATA_ATTR uint8_t  rtcPresets[sizeof(Presets)];
+RTC_DATA_ATTR uint8_t  rtcPattern[NUM_STRIPS];
+
+#if TOUCH_BACKGROUND
+TaskHandle_t      touchTask       = nullptr;
+TaskHandle_t      touchParkWaiter = nullptr;   // set before the request
+std::atomic<bool> gTouchPark{false};           // loop → touch task: leave the bus
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  Calibration cache
+ *  -----------------
+ *  After a cold learn the settled baselines and the auto-configured charge
+ *  current / time of every channel are stored in NVS.  At the next boot they
+ *  are written back with auto-config off and baseline tracking seeded from
+ *  the registers (ECR CL = 00), so touches are valid right away.  If the
+ *  first filtered data disagree with the cached baselines, the sensor is
+ *  reset and learns from scratch.
+ * ------------------------------------------------------------------------ */
+constexpr uint8_t  MPR_CDC0         = 0x5F;    // 13 × charge current
+constexpr uint8_t  MPR_CDT0         = 0x6C;    // 7 × charge time (2 per byte)
+constexpr uint8_t  MPR_AUTOCONFIG0  = 0x7B;
+constexpr uint8_t  AUTOCONFIG_OFF   = 0x08;    // keep BVA, clear ARE / ACE
+constexpr uint8_t  ECR_RUN_CACHED   = 0x0C;    // CL=00, ELE0-11
+constexpr uint8_t  CAL_VERSION      = 1;
+
+struct CalImage {
+  uint8_t version;
+  uint8_t baseline[NUM_CHANNELS];              // register value (bits 9:2)
+  uint8_t cdc[NUM_CHANNELS];
+  uint8_t cdt[7];
+};
+
+uint8_t       calPending  = 0;                 // sensors still to be cached
+uint8_t       touchReady  = 0;                 // sensors whose baselines sit on the data
+unsigned long tCalStart[NUM_TOUCH_SENSORS] = {};
+
+/* ---------------------------------------------------------------------------
+ *  Sensor bring-up
+ *  ---------------
+ *  setup() lights the strips first and leaves the MPR121s to the touch
+ *  context, which tries each one and retries a missing sensor with doubling
+ *  back-off.  Until a sensor answers its electrodes read as released, so the
+ *  lamps restored from sleep keep running ("lights-only").
+ * ------------------------------------------------------------------------ */
+constexpr uint8_t SENSORS_ALL = _BV(NUM_TOUCH_SENSORS) - 1;
+
+std::atomic<uint8_t> gSensorsUp{0};            // written by the touch context
+
+/* Demo / show-mode colours */
+const uint32_t colShowGyroA = pxMain.Color( 38, 196, 236);
+const uint32_t colShowGyroB = pxMain.Color( 20, 148,  20);
+const uint32_t colShowTurn  = pxMain.Color(187, 210, 225);
+const uint32_t colShowMain  = pxMain.Color(255,   0, 127);
+
+/* ---------------------------------------------------------------------------
+ *  HSV
+ *  ---
+ *  Hue is 0…255 around the wheel.  The fully saturated, full-value colour of
+ *  every hue is computed at compile time into a 768-byte table in flash;
+ *  saturation and value are then applied with 8.8 fixed-point multiplies
+ *  (x · (s + 1) >> 8), two per channel.
+ * ------------------------------------------------------------------------ */
+struct HueWheel { uint8_t rgb[256][3]; };
+
+constexpr HueWheel makeHueWheel()
+{
+  HueWheel w{};
+  for (int h = 0; h < 256; ++h) {
+    int     p    = h * 6;                      // 256 steps per sextant
+    uint8_t up   = (255 * (p & 0xFF) + 128) >> 8;
+    uint8_t down = 255 - up;
+    uint8_t r = 0, g = 0, b = 0;
+    switch (p >> 8) {
+      case 0:  r = 255;  g = up;   break;
+      case 1:  r = down; g = 255;  break;
+      case 2:  g = 255;  b = up;   break;
+      case 3:  g = down; b = 255;  break;
+      case 4:  r = up;   b = 255;  break;
+      default: r = 255;  b = down; break;
+    }
+    w.rgb[h][0] = r; w.rgb[h][1] = g; w.rgb[h][2] = b;
+  }
+  return w;
+}
+constexpr HueWheel HUE_WHEEL = makeHueWheel();    // .rodata → flash
+
+constexpr uint8_t  RAINBOW_FRAME_MS = 10;
+constexpr uint8_t  RAINBOW_STEP     = 256 / (NUM_GYRO_PIXELS + NUM_TURN_PIXELS +
+                                             NUM_HEADTAIL_PIXELS);   // one wheel
+
+/* ---------------------------------------------------------------------------
+ *  Value noise
+ *  -----------
+ *  2-D value noise on an 8.8 lattice: the corner values come from a 256-byte
+ *  permutation (shuffled at compile time, kept in flash), blended with an
+ *  8-bit smoothstep.  Shifts, adds and byte multiplies only – no floats, no
+ *  division – so it is cheap enough per pixel per frame.
+ * ------------------------------------------------------------------------ */
+struct NoisePerm { uint8_t p[256]; };
+
+constexpr NoisePerm makeNoisePerm()
+{
+  NoisePerm t{};
+  for (int i = 0; i < 256; ++i) t.p[i] = i;
+  uint32_t r = 0x2545F491;                     // fixed seed, LCG Fisher–Yates
+  for (int i = 255; i > 0; --i) {
+    r = r * 1664525u + 1013904223u;
+    int     j   = (r >> 16) % (i + 1);
+    uint8_t tmp = t.p[i];
+    t.p[i] = t.p[j];
+    t.p[j] = tmp;
+  }
+  return t;
+}
+constexpr NoisePerm NOISE_PERM = makeNoisePerm();  // .rodata → flash
+
+constexpr uint8_t  NOISE_FRAME_MS   = 20;      // fire / glow frame
+constexpr uint16_t SHOW_ACT_MS      = 10000;   // show mode: time per act
+
+/* ---------------------------------------------------------------------------
+ *  Effect scripts
+ *  --------------
+ *  Effects are written as stackless coroutines that sleep or wait for an
+ *  event instead of calling delay(); scriptsRun() resumes whichever are due.
+ *  The same script source builds as a C++20 coroutine or, on toolchains
+ *  without them, as a protothread (switch on __LINE__).  Either way a script
+ *  keeps its state in its Script slot, so:
+ *    – anything that must survive a SCRIPT_SLEEP / SCRIPT_WAIT lives in
+ *      self.a / self.b / self.i, never in a local;
+ *    – no `switch` statements inside a script body.
+ *  SCRIPT_SLEEP advances a deadline, so periodic scripts do not drift.
+ * ------------------------------------------------------------------------ */
+#ifndef MAX_SCRIPTS                            // concurrent scripts (slots)
+#  define MAX_SCRIPTS  8
+#endif
+
+constexpr uint32_t EV_TOUCH         = _BV(0);  // a press event was resolved
+
+struct Script;
+
+#if SCRIPT_COROUTINES
+struct ScriptTask {
+  struct promise_type {
+    ScriptTask          get_return_object()   { return { std::coroutine_handle<promise_type>::from_promise(*this) }; }
+    std::suspend_always initial_suspend()     { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void                return_void()         {}
+    void                unhandled_exception() {}
+  };
+  std::coroutine_handle<promise_type> h;
+};
+typedef ScriptTask (*ScriptFn)(Script &);
+#else
+typedef bool (*ScriptFn)(Script &);            // false = finished
+#endif
+
+struct Script {
+  ScriptFn      fn     = nullptr;              // nullptr = free slot
+  unsigned long tWake  = 0;
+  uint32_t      waitEv = 0;                    // 0 = waiting on time only
+  uint8_t       a = 0, b = 0;                  // script state across yields
+  uint16_t      i = 0;
+#if SCRIPT_COROUTINES
+  std::coroutine_handle<> h;
+#else
+  uint16_t      line   = 0;
+#endif
+};
+Script   scripts[MAX_SCRIPTS];
+uint32_t scriptEvents = 0;                     // posted since the last run
+
+#if SCRIPT_COROUTINES
+struct ScriptYield {
+  Script       &self;
+  uint32_t      ev;
+  bool await_ready() const noexcept           { return false; }
+  void await_suspend(std::coroutine_handle<>) { self.waitEv = ev; }
+  void await_resume() const noexcept          {}
+};
+#  define SCRIPT(name)      ScriptTask name(Script &self)
+#  define SCRIPT_BEGIN()
+#  define SCRIPT_SLEEP(ms)  do { self.tWake += (ms); co_await ScriptYield{self, 0}; } while (0)
+#  define SCRIPT_WAIT(ev)   co_await ScriptYield{self, (ev)}
+#  define SCRIPT_END()      co_return
+#else
+#  define SCRIPT(name)      bool name(Script &self)
+#  define SCRIPT_BEGIN()    switch (self.line) { case 0:
+#  define SCRIPT_SLEEP(ms)  do { self.tWake += (ms); self.line = __LINE__; return true; \
+                                 case __LINE__:; } while (0)
+#  define SCRIPT_WAIT(ev)   do { self.waitEv = (ev); self.line = __LINE__; return true; \
+                                 case __LINE__:; } while (0)
+#  define SCRIPT_END()      } self.line = 0; return false
+#endif
+
+/* ---------------------------------------------------------------------------
+ *  Forward declarations
+ * ------------------------------------------------------------------------ */
+void stripSet(StripId s, uint16_t i, uint32_t c);
+void stripBrightness(StripId s, uint8_t br);
+void stripShow(StripId s);
+bool stripRefreshDue(StripId s, unsigned long nowUs);
+void clearStrip(StripId s);
+void paintGyro   (Canvas to, bool state, uint32_t c1, uint32_t c2);
+void toggleGyro  (bool state, uint32_t c1, uint32_t c2);
+void toggleHazard(bool state, uint32_t c);
+void compose(unsigned long nowUs);
+void composeInvalidate(StripId s);
+void renderFrame(FrameImage &f, uint32_t st, const Presets &p, const LampScene &sc,
+                 unsigned long tt, uint8_t dirty, long &wait);
+void commitFrame(const FrameImage &f, JitterPath path, bool edge);
+void ringFill(uint32_t st, const Presets &p, const LampScene &sc);
+void jitterPrint();
+void jitterReset();
+void encodeBench();
+uint8_t featureFrame(Feature f, const LampScene &sc, unsigned long now, long &wait);
+void frameTimerArm(unsigned long now, long wait);
+uint8_t patternFrame(FlashPattern p, unsigned long t, long &wait);
+void paintHalves(Canvas to, const LampGroupMap &m, uint8_t halves, uint32_t cA, uint32_t cB);
+void patternSelect(StripId s, FlashPattern p);
+void renderGroup(Canvas to, LampGroup g, Feature f, uint8_t frame, uint32_t st,
+                 const Presets &p, const LampScene &sc);
+
+uint8_t  potToBrightness(int raw);
+uint32_t potToWhiteShade (int raw);
+uint32_t potToRedShade   (int raw);
+uint32_t potToAmberShade (int raw);
+uint32_t hsv(uint8_t h, uint8_t s, uint8_t v);
+void     fillRainbow(StripId s, uint8_t hue0, uint8_t dHue);
+uint8_t  noise2(uint16_t x, uint16_t y);
+uint32_t heatColour(uint8_t heat);
+
+void waitRelease(uint8_t electrode);
+TouchMask chordResolve(TouchMask raw, unsigned long now);
+bool scriptStart(ScriptFn fn);
+void scriptsRun(unsigned long now);
+void scriptStop(ScriptFn fn);
+void scriptsStopAll();
+void scriptPost(uint32_t ev);
+void effectToggle(uint32_t bit);
+bool mprRead(uint8_t addr, uint8_t reg, uint8_t *buf, uint8_t len);
+bool touchBurstRead(uint8_t addr, TouchSample &s);
+bool calLoad(uint8_t n);
+void calSave(uint8_t n);
+bool calSettled(const TouchSample &s);
+void touchPoll();
+void touchBringUp(unsigned long now);
+void touchAttachIrqs();
+TouchMask touchState();
+uint16_t swDetect(const TouchSample &s, SwDetector *det);
+void sliderUpdate(const TouchSample &s);
+void statsUpdate(uint8_t n, const TouchSample &s, uint16_t bits, unsigned long now);
+void statsService();
+void statsPrint();
+void serialCommands();
+uint16_t isqrt32(uint32_t v);
+int  readAdjust();
+void sliderSeed(uint8_t br);
+bool powerRestore();
+void powerIdleCheck(TouchMask touchNow);
+void powerEnterSleep();
+void longPressUpdate(TouchMask raw, unsigned long now);
+void brStep(StripId s, int8_t &dir);
+void brCommit();
+
+template<typename ToggleFn, typename CfgFn>
+void handleTap(TouchMask touchNow, TouchMask keyMask, TapTimer &tap,
+               uint32_t cfgBit, uint16_t halfPeriod,
+               ToggleFn onToggle, CfgFn onConfig);
+
+/* ---------------------------------------------------------------------------
+ *  SETUP
+ * ------------------------------------------------------------------------ */
+void setup()
+{
+  Serial.begin(9600);
+
+#if defined(ESP32)
+  frameLock = xSemaphoreCreateRecursiveMutex();
+  esp_timer_create_args_t ta = {};
+  ta.callback = [](void *) { compose(micros()); };
+  ta.name     = "frame";
+  esp_timer_create(&ta, &frameTimer);
+#endif
+
+  pxGyro.begin();
+  pxTurn.begin();
+  pxMain.begin();
+
+  bool woke = powerRestore();
+
+  stripBrightness(STRIP_GYRO, preset().brGyroInit);
+  stripBrightness(STRIP_TURN, preset().brTurnInit);
+  stripBrightness(STRIP_MAIN, preset().brMainInit);
+
+  /* First frame: restored lamps or dark, one show() per strip */
+  compose(micros());
+  unsigned long tFirst = millis();
+  Serial.print(woke ? F("Wake → first frame ") : F("Boot → first frame "));
+  Serial.print(tFirst);
+  Serial.println(tFirst > FIRST_FRAME_MS ? F(" ms (over budget)") : F(" ms"));
+
+  /* Sensors come up in the touch context – lights work meanwhile */
+  touchAttachIrqs();
+
+#if TOUCH_BACKGROUND
+  xTaskCreatePinnedToCore([](void *) {
+                            TickType_t tWake = xTaskGetTickCount();
+                            for (;;) {
+                              touchPoll();
+                              if (gTouchPark.load(std::memory_order_acquire)) {
+                                xTaskNotifyGive(touchParkWaiter);   // bus is idle
+                                vTaskSuspend(nullptr);
+                              }
+                              vTaskDelayUntil(&tWake, pdMS_TO_TICKS(TOUCH_POLL_US / 1000));
+                            }
+                          },
+                          "touch", 4096, nullptr, 2, &touchTask, 0);   // NVS in bring-up
+#endif
+}
+
+/* ---------------------------------------------------------------------------
+ *  LOOP
+ * ------------------------------------------------------------------------ */
+void loop()
+{
+  serialCommands();
+
+  TouchMask touchRaw = touchState();
+  TouchMask touchNow = chordResolve(touchRaw, millis());
+  if (touchNow) {
+    Serial.print(F("Touch 0x"));
+    Serial.print(touchNow, HEX);
+    Serial.println(F(" detected"));
+    scriptPost(EV_TOUCH);
+  }
+
+  /* Tap tempo on CTRL – timed from the press, not the chord resolver's emit */
+  if (touchNow == TK_CTRL) tempoTap(chord.tFirst);
+
+  /* -----------------------------------------------------------------------
+   *  DEMO “SHOW MODE” / RAINBOW – effect scripts own the strips meanwhile
+   * -------------------------------------------------------------------- */
+  if (touchNow == TK_SHOW)    effectToggle(ST_SHOW);
+  if (touchNow == TK_RAINBOW) effectToggle(ST_RAINBOW);
+  scriptsRun(tempoNow());
+  if (stateTest(ST_EFFECTS)) {
+    compose(micros());              // keeps the effect on record as owner
+    powerIdleCheck(touchRaw);
+    return;
+  }
+
+  /* -----------------------------------------------------------------------
+   *  GYRO BEACON  ──────────────────────────────────────────────────────────
+   * -------------------------------------------------------------------- */
+  handleTap(touchNow, TK_GYRO, tapGyro, ST_CFG_GYRO_BR,
+            HP_GYRO,
+            [](){                 // on-toggle
+              originSync(&LampScene::tOrgGyro);    // start lit
+              stateToggle(ST_GYRO);
+            },
+            [](){                 // brightness-config loop
+              stateSet(ST_CFG_GYRO_BR);
+              sliderSeed(preset().brGyroInit);
+              while (stateTest(ST_CFG_GYRO_BR)) {
+                int raw  = readAdjust();
+                uint8_t br = potToBrightness(raw);
+                stripBrightness(STRIP_GYRO, br);
+                composeInvalidate(STRIP_GYRO);
+                compose(micros());
+
+                if (touchState() == TK_CTRL) {
+                  gPresets.write([br](Presets &p){ p.brGyroInit = br; });
+                  waitRelease(5);
+                  stateClear(ST_CFG_GYRO_BR | ST_GYRO);
+                }
+                if (touchState() == TK_GYRO) {
+                  stripBrightness(STRIP_GYRO, preset().brGyroInit);
+                  waitRelease(0);
+                  stateClear(ST_CFG_GYRO_BR | ST_GYRO);
+                }
+              }
+            });
+
+  /* Colour swap: CTRL + GYRO (white ↔ red for the first 4 pixels) */
+  if (touchNow == TK_GYRO_COL) {
+    gPresets.write([](Presets &p){
+      p.colGyroA = (p.colGyroA == pxGyro.Color(255,255,255)) ?
+                   pxGyro.Color(255,0,0) : pxGyro.Color(255,255,255);
+    });
+  }
+
+  /* -----------------------------------------------------------------------
+   *  TURN SIGNALS  (RIGHT / LEFT / HAZARD)
+   * -------------------------------------------------------------------- */
+  handleTap(touchNow, TK_TURN_R, tapTurnR, ST_CFG_TURN_BR,
+            HP_TURN,
+            [](){                                  // toggle right
+              turnSync();
+              stateToggle(ST_TURN_R, ST_TURN_L | ST_HAZARD);
+            },
+            [](){                                  // brightness setup
+              stateSet(ST_CFG_TURN_BR);
+              sliderSeed(preset().brTurnInit);
+              while (stateTest(ST_CFG_TURN_BR)) {
+                int raw  = readAdjust();
+                uint8_t br = potToBrightness(raw);
+                stripBrightness(STRIP_TURN, br);
+                composeInvalidate(STRIP_TURN);
+                compose(micros());
+
+                if (touchState() == TK_CTRL) {
+                  gPresets.write([br](Presets &p){ p.brTurnInit = br; });
+                  waitRelease(5);
+                  stateClear(ST_CFG_TURN_BR);
+                }
+                if (touchState() & TK_HAZARD) {
+                  stripBrightness(STRIP_TURN, preset().brTurnInit);
+                  waitRelease(1);  // either electrode 1 or 2 is fine
+                  stateClear(ST_CFG_TURN_BR);
+                }
+              }
+            });
+
+  /* ─────────────────────────────────────────────────────────────────---- */
+  handleTap(touchNow, TK_TURN_L, tapTurnL, ST_CFG_TURN_BR,
+            HP_TURN,
+            [](){                                  // toggle left
+              turnSync();
+              stateToggle(ST_TURN_L, ST_TURN_R | ST_HAZARD);
+            },
+            [](){ stateClear(ST_CFG_TURN_BR); });   // brightness config handled above – skip here
+
+  /* ─────────────────────────────────────────────────────────────────---- */
+  /* Hazard (both turn buttons together) – overrides, a running turn signal
+     carries on underneath and shows again once hazard is off */
+  if (touchNow == TK_HAZARD) {
+    turnSync();
+    stateToggle(ST_HAZARD);
+  }
+
+  /* -----------------------------------------------------------------------
+   *  HEAD- / TAIL-LIGHTS
+   * -------------------------------------------------------------------- */
+  handleTap(touchNow, TK_HEAD, tapMain, ST_CFG_MAIN_BR,
+            HP_TURN,
+            [](){                                   // toggle headlights
+              originSync(&LampScene::tOrgHead);
+              stateToggle(ST_HEAD, ST_LOW_BEAM);
+            },
+            [](){                                   // brightness setup
+              stateSet(ST_CFG_MAIN_BR);
+              sliderSeed(preset().brMainInit);
+              while (stateTest(ST_CFG_MAIN_BR)) {
+                int raw  = readAdjust();
+                uint8_t br = potToBrightness(raw);
+                stripBrightness(STRIP_MAIN, br);
+                composeInvalidate(STRIP_MAIN);
+                compose(micros());
+
+                if (touchState() == TK_CTRL) {
+                  gPresets.write([br](Presets &p){ p.brMainInit = br; });
+                  waitRelease(5);
+                  stateClear(ST_CFG_MAIN_BR | ST_HEAD | ST_TAIL);
+                }
+                if (touchState() == TK_HEAD) {
+                  stripBrightness(STRIP_MAIN, preset().brMainInit);
+                  waitRelease(3);
+                  stateClear(ST_CFG_MAIN_BR | ST_HEAD | ST_TAIL);
+                }
+              }
+            });
+
+  /* Tail lights (simple ON/OFF) */
+  if (touchNow == TK_TAIL) stateToggle(ST_TAIL);
+
+  /* Low beam (outer head pixels; full headlights take precedence) */
+  if (touchNow == TK_LOW_BEAM) stateToggle(ST_LOW_BEAM);
+
+  /* -----------------------------------------------------------------------
+   *  COLOUR CONFIGURATION LOOPS
+   * -------------------------------------------------------------------- */
+  if (touchNow == TK_HEAD_COL) {
+    while (touchState() & TK_HEAD_COL) delay(10);   // CTRL alone would confirm
+    stateSet(ST_CFG_HEAD_COL);
+    while (stateTest(ST_CFG_HEAD_COL)) {
+      int raw  = readAdjust();
+      uint32_t c = potToWhiteShade(raw);
+      gScene.write([c](LampScene &s){ s.cfgColour = c; });
+      composeInvalidate(STRIP_MAIN);
+      compose(micros());
+
+      if (touchState() == TK_CTRL) {
+        gPresets.write([c](Presets &p){ p.colHeadInit = c; });
+        waitRelease(5);
+        stateClear(ST_CFG_HEAD_COL);
+      }
+      if (touchState() == TK_HEAD) {
+        waitRelease(3);
+        stateClear(ST_CFG_HEAD_COL);
+      }
+    }
+  }
+
+  if (touchNow == TK_TAIL_COL) {
+    while (touchState() & TK_TAIL_COL) delay(10);
+    stateSet(ST_CFG_TAIL_COL);
+    while (stateTest(ST_CFG_TAIL_COL)) {
+      int raw  = readAdjust();
+      uint32_t c = potToRedShade(raw);
+      gScene.write([c](LampScene &s){ s.cfgColour = c; });
+      composeInvalidate(STRIP_MAIN);
+      compose(micros());
+
+      if (touchState() == TK_CTRL) {
+        gPresets.write([c](Presets &p){ p.colTailInit = c; });
+        waitRelease(5);
+        stateClear(ST_CFG_TAIL_COL);
+      }
+      if (touchState() == TK_TAIL) {
+        waitRelease(4);
+        stateClear(ST_CFG_TAIL_COL);
+      }
+    }
+  }
+
+  /* -----------------------------------------------------------------------
+   *  LONG-PRESS BRIGHTNESS
+   * -------------------------------------------------------------------- */
+  longPressUpdate(touchRaw, millis());
+  brCommit();
+
+  /* -----------------------------------------------------------------------
+   *  FRAME – resolve lamp owners, paint what changed
+   * -------------------------------------------------------------------- */
+  compose(micros());
+
+  /* -----------------------------------------------------------------------
+   *  LOW POWER
+   * -------------------------------------------------------------------- */
+  powerIdleCheck(touchRaw);
+}
+
+/* ===========================================================================
+ *  HELPER FUNCTIONS
+ * ======================================================================== */
+/* ---------------------------------------------------------------------------
+ *  handleTap()
+ *  ----------
+ *  Generic double-tap detector + dispatcher.
+ * ------------------------------------------------------------------------ */
+template<typename ToggleFn, typename CfgFn>
+void handleTap(TouchMask touchNow,
+               TouchMask keyMask,
+               TapTimer &tap,
+               uint32_t cfgBit,
+               uint16_t halfPeriod,
+               ToggleFn onToggle,
+               CfgFn    onConfig)
+{
+  /* flush stale taps (>1 s) */
+  if (tap.count && millis() - tap.first > 1000) tap.count = 0;
+
+  if (touchNow == keyMask) {            // electrode touched
+    tap.count++;
+    if (tap.count == 1) tap.first = millis();
+
+    /* Double-tap → config loop (entered once the finger is off, so the
+       loop does not read it as "cancel") */
+    if (tap.count == 2 && millis() - tap.first < 500) {
+      tap.count = 0;
+      waitRelease(__builtin_ctzll(keyMask));
+      stateSet(cfgBit);
+      onConfig();
+      return;
+    }
+
+    /* Single tap → ON / OFF */
+    if (tap.count == 1) {
+      onToggle();
+    }
+  }
+
+  /* Blinking handled outside */
+}
+
+/* ---------------------------------------------------------------------------
+ *  Output stage
+ * ------------------------------------------------------------------------ */
+void stripSet(StripId s, uint16_t i, uint32_t c)
+{
+#if LED_SHADOW
+  OutputStrip        &o       = outStage[s];
+  const WhiteBalance &wb      = strips[s]->whiteBalance();
+  const uint8_t       gain[3] = { wb.r, wb.g, wb.b };
+  o.colour[i] = c;
+  for (uint8_t ch = 0; ch < 3; ++ch)
+    o.lin[i][ch] = (uint32_t(GAMMA16.v[uint8_t(c >> (16 - 8 * ch))]) * (gain[ch] + 1) >> 8) *
+                   (o.br + 1) >> 8;
+#else
+  strips[s]->setPixelColor(i, c);
+#endif
+}
+
+/* New level for the pixels set from now on (under LED_SHADOW the kept
+   colours are re-scaled at once); callers repaint the strip */
+void stripBrightness(StripId s, uint8_t br)
+{
+  FrameGuard lock;                             // vs. compose() on the timer task
+#if LED_SHADOW
+  OutputStrip &o = outStage[s];
+  o.br = br;
+  for (uint16_t i = 0; i < strips[s]->numPixels(); ++i) stripSet(s, i, o.colour[i]);
+#else
+  strips[s]->setBrightness(br);
+#endif
+#if RUN_AHEAD
+  ring.count = 0;                              // its frames repaint changed groups only
+#endif
+}
+
+/* One filament step: y += (target − y) · α, α in Q15, faster when heating */
+inline uint16_t lampStep(uint16_t &y, uint16_t target, uint16_t aUp, uint16_t aDown)
+{
+  int32_t d    = int32_t(target) - y;
+  int32_t step = d * (d > 0 ? aUp : aDown) >> 15;
+  y = step ? y + step : target;                // snap the last fraction
+  return y;
+}
+
+void stripShow(StripId s)
+{
+  FrameGuard lock;
+#if LED_SHADOW
+  OutputStrip       &o   = outStage[s];
+  PixelBuffer       &px  = *strips[s];
+  unsigned long      now = micros();
+#  if LAMP_MODEL
+  uint32_t dt = now - o.tSent;
+  if (dt > 50000) dt = 50000;                  // idle strip: settled anyway
+  uint16_t aUp   = (dt << 15) / (dt + LAMP_TAU_UP_MS   * 1000UL);
+  uint16_t aDown = (dt << 15) / (dt + LAMP_TAU_DOWN_MS * 1000UL);
+  bool     moving = false;
+#  endif
+  uint16_t fr = 0;
+  for (uint16_t i = 0; i < px.numPixels(); ++i) {
+    uint8_t out[3];
+    for (uint8_t ch = 0; ch < 3; ++ch) {
+      uint16_t v = o.lin[i][ch];
+#  if LAMP_MODEL
+      if (LAMP_PX[s] & _BV(i)) {
+        v       = lampStep(o.lamp[i][ch], v, aUp, aDown);
+        moving |= v != o.lin[i][ch];
+      }
+#  endif
+#  if LED_DITHER
+      uint16_t acc = (v & 0xFF) + o.err[i][ch];
+      out[ch]      = (v >> 8) + (acc >> 8);
+      o.err[i][ch] = acc;                      // keeps the low byte
+      fr          |= v & 0xFF;
+#  else
+      out[ch]      = v >> 8;
+#  endif
+    }
+    px.setPixelLevels(i, out[0], out[1], out[2]);
+  }
+  o.frac  = fr != 0;
+#  if LAMP_MODEL
+  o.settling = moving;
+#  endif
+  o.tSent = now;
+#endif
+  stripTransmit(s);
+}
+
+/* True when the output stage needs another frame of a strip on its own:
+   in-between dither levels or a filament still heating / cooling */
+bool stripRefreshDue(StripId s, unsigned long nowUs)
+{
+#if LED_SHADOW
+  const OutputStrip &o = outStage[s];
+  return (o.frac     && nowUs - o.tSent >= DITHER_FRAME_US) ||
+         (o.settling && nowUs - o.tSent >= LAMP_FRAME_US);
+#else
+  (void)s; (void)nowUs;
+  return false;
+#endif
+}
+
+/* ---------------------------------------------------------------------------
+ *  Strip helpers
+ * ------------------------------------------------------------------------ */
+void clearStrip(StripId s)
+{
+  FrameGuard lock;
+  for (uint16_t i = 0; i < strips[s]->numPixels(); ++i)
+    stripSet(s, i, 0);
+  stripShow(s);
+}
+
+inline void canvasSet(Canvas to, StripId s, uint16_t i, uint32_t c)
+{
+  if (to) to[s][i] = c;
+  else    stripSet(s, i, c);
+}
+
+void paintGyro(Canvas to, bool phase, uint32_t c1, uint32_t c2)
+{
+  /* Two interleaved groups of four pixels */
+  for (uint8_t i = 0; i < 8; ++i) {
+    bool groupA = (i < 2) || (i > 5);
+    canvasSet(to, STRIP_GYRO, i, phase ^ groupA ? c1 : c2);
+  }
+}
+void toggleGyro(bool phase, uint32_t c1, uint32_t c2)
+{
+  paintGyro(nullptr, phase, c1, c2);
+  stripShow(STRIP_GYRO);
+}
+void toggleHazard(bool phase, uint32_t c)
+{
+  for (uint8_t i = 0; i < NUM_TURN_PIXELS; ++i)
+    stripSet(STRIP_TURN, i, phase ? c : 0);
+  stripShow(STRIP_TURN);
+}
+
+/* ---------------------------------------------------------------------------
+ *  Lamp arbiter / compositor
+ * ------------------------------------------------------------------------ */
+void compose(unsigned long now)                // real µs
+{
+  FrameGuard    lock;
+  uint32_t      st   = stateSnapshot();
+#if RUN_AHEAD
+  uint32_t      pv   = gPresets.version.load(std::memory_order_acquire);
+  uint32_t      sv   = gScene.version.load(std::memory_order_acquire);
+#endif
+  Presets       p    = gPresets.snapshot();    // loop or timer context
+  LampScene     sc   = gScene.snapshot();
+  long          wait = NO_DEADLINE;            // tempo ms to the next frame edge
+  unsigned long tt   = tempoTick(now);
+  bool          edge = comp.armed && long(now - comp.tArmed) >= 0;
+
+#if RUN_AHEAD
+  if (ring.count && (comp.dirty || st != ring.state || pv != ring.presets || sv != ring.scene))
+    ring.count = 0;                            // rendered for another input
+  if (ring.count) {
+    const FrameImage &f = ring.f[ring.head];
+    if (long(tt - f.tt) >= 0) {                // due: copy out, nothing to render
+      commitFrame(f, JIT_AHEAD, edge);
+      comp.img  = f;
+      ring.head = (ring.head + 1) % RUN_AHEAD;
+      ring.count--;
+    } else {
+      commitFrame(FrameImage(), JIT_AHEAD, false);   // output-stage refreshes only
+    }
+  } else
+#endif
+  {
+    renderFrame(comp.img, st, p, sc, tt, comp.dirty, wait);
+    comp.dirty = 0;
+    commitFrame(comp.img, JIT_INLINE, edge);
+#if RUN_AHEAD
+    ring.state   = st;
+    ring.presets = pv;
+    ring.scene   = sv;
+    ring.open    = wait != NO_DEADLINE;
+    ring.ttNext  = tt + wait;
+#endif
+  }
+
+#if RUN_AHEAD
+  ringFill(st, p, sc);                         // after the transmit, off the edge
+  if (ring.count) {
+    long ahead = long(ring.f[ring.head].tt - tt);
+    wait = ahead > 0 ? ahead : 0;              // behind: fire at once
+  }
+#endif
+  if (wait != NO_DEADLINE) {                   // → real µs to the tick that reaches it
+    uint64_t q = (uint64_t(wait) * 1000 << 16);   // tempo µs to the edge, Q16
+    q    = q > tempo.frac ? q - tempo.frac : 0;
+    wait = long((q + tempo.rate - 1) / tempo.rate);
+  }
+  frameTimerArm(now, wait);
+}
+
+/* Paint into `f` the groups whose key at tempo time `tt` differs from the
+   one `f` holds (or that are dirty); lowers `wait` to the next frame edge */
+void renderFrame(FrameImage &f, uint32_t st, const Presets &p, const LampScene &sc,
+                 unsigned long tt, uint8_t dirty, long &wait)
+{
+  uint16_t req[NUM_GROUPS] = {};               // one bit per claiming Feature
+  for (const Claim &c : CLAIMS)
+    if (st & c.bits)
+      for (uint8_t m = c.groups; m; m &= m - 1)
+        req[__builtin_ctz(m)] |= _BV(c.f);
+
+  f.tt     = tt;
+  f.groups = 0;
+  for (uint8_t g = 0; g < NUM_GROUPS; ++g) {
+    Feature  owner = req[g] ? Feature(31 - __builtin_clz(req[g])) : FT_NONE;
+    uint8_t  frame = featureFrame(owner, sc, tt, wait);
+    uint16_t key   = owner << 4 | frame;
+    if (key == f.key[g] && !(dirty & _BV(g))) continue;
+    f.key[g] = key;
+    renderGroup(f.px, LampGroup(g), owner, frame, st, p, sc);
+    if (owner != FT_SHOW) f.groups |= _BV(g);  // the scripts paint their own
+  }
+}
+
+/* Hand the repainted groups of `f` to the output stage and transmit them,
+   plus any strip the output stage wants refreshed */
+void commitFrame(const FrameImage &f, JitterPath path, bool edge)
+{
+  uint8_t show = 0;                            // one bit per StripId
+  for (uint8_t g = 0; g < NUM_GROUPS; ++g) {
+    if (!(f.groups & _BV(g))) continue;
+    const LampGroupMap &m = GROUPS[g];
+    for (uint8_t i = 0; i < m.count; ++i) stripSet(m.strip, m.px[i], f.px[m.strip][m.px[i]]);
+    show |= _BV(m.strip);
+  }
+
+  unsigned long us = micros();
+  if (show && edge) {
+    CommitJitter &j    = jitter[path];
+    long          late = long(us - comp.tArmed);
+    j.n++;
+    j.sumUs += late;
+    if (late < j.minUs) j.minUs = late;
+    if (late > j.maxUs) j.maxUs = late;
+  }
+  for (uint8_t s = 0; s < NUM_STRIPS; ++s)
+    if ((show & _BV(s)) || stripRefreshDue(StripId(s), us)) stripShow(StripId(s));
+}
+
+#if RUN_AHEAD
+/* Top the ring up with the frames at the next edges, each one painted on
+   top of the previous */
+void ringFill(uint32_t st, const Presets &p, const LampScene &sc)
+{
+  while (ring.open && ring.count < RUN_AHEAD) {
+    const FrameImage &prev = ring.count ? ring.f[(ring.head + ring.count - 1) % RUN_AHEAD]
+                                        : comp.img;
+    FrameImage       &f    = ring.f[(ring.head + ring.count) % RUN_AHEAD];
+    long              wait = NO_DEADLINE;
+    f = prev;
+    renderFrame(f, st, p, sc, ring.ttNext, 0, wait);
+    ring.count++;
+    ring.open    = wait != NO_DEADLINE;
+    ring.ttNext += wait;
+  }
+}
+#endif
+
+/* (Re)arm the frame timer for real µs now + wait */
+void frameTimerArm(unsigned long now, long wait)
+{
+  unsigned long tNext = now + wait;
+  if (wait == NO_DEADLINE) {
+#if defined(ESP32)
+    if (comp.armed && frameTimer) esp_timer_stop(frameTimer);
+#endif
+    comp.armed = false;
+    return;
+  }
+  if (comp.armed && tNext == comp.tArmed) return;
+#if defined(ESP32)
+  if (!frameTimer) return;
+  if (comp.armed) esp_timer_stop(frameTimer);
+  long us = long(tNext - micros());
+  esp_timer_start_once(frameTimer, us > 0 ? us : 0);
+#endif
+  comp.tArmed = tNext;                         // elsewhere loop() polls compose()
+  comp.armed  = true;
+}
+
+/* Repaint every group of a strip on the next frame (brightness changed) */
+void composeInvalidate(StripId s)
+{
+  FrameGuard lock;
+  for (uint8_t g = 0; g < NUM_GROUPS; ++g)
+    if (GROUPS[g].strip == s) comp.dirty |= _BV(g);
+}
+
+/* Animation frame of a feature at tempo time `now` (0 = dark half-period, steady
+ * features are always 1); lowers `wait` to the ms until that frame ends.
+ * A sweeping turn signal counts up one frame per lit pixel. */
+uint8_t featureFrame(Feature f, const LampScene &sc, unsigned long now, long &wait)
+{
+  unsigned long tOrg;
+  uint16_t      hp;
+  FlashPattern  pat;
+  switch (f) {
+    case FT_GYRO:   tOrg = sc.tOrgGyro; hp = HP_GYRO; pat = FlashPattern(sc.pattern[STRIP_GYRO]); break;
+    case FT_HAZARD: tOrg = sc.tOrgTurn; hp = HP_TURN; pat = FlashPattern(sc.pattern[STRIP_TURN]); break;
+    case FT_TURN_R:
+    case FT_TURN_L: tOrg = sc.tOrgTurn; hp = HP_TURN; pat = PAT_DEFAULT;                         break;
+    case FT_HEAD:   tOrg = sc.tOrgHead; hp = 0;       pat = FlashPattern(sc.pattern[STRIP_MAIN]); break;
+    default:        return 1;
+  }
+  if (pat)  return patternFrame(pat, now - tOrg, wait);
+  if (!hp)  return 1;                          // steady without a pattern
+  unsigned long t    = now - tOrg;
+  uint16_t      in   = t % hp;                 // into this half-period
+  long          left = hp - in;
+  uint8_t       frame = (t / hp & 1) == 0;     // first half-period lit
+
+#if SEQ_TURN
+  static_assert(SEQ_STEPS < FRAME_PATTERN, "sweep frames stay below the pattern flag");
+  if (frame && f != FT_GYRO && in < (SEQ_STEPS - 1) * SEQ_STEP_MS) {
+    frame = 1 + in / SEQ_STEP_MS;
+    left  = SEQ_STEP_MS - in % SEQ_STEP_MS;
+  } else if (frame && f != FT_GYRO) {
+    frame = SEQ_STEPS;
+  }
+#endif
+  if (left < wait) wait = left;
+  return frame;
+}
+
+/* Halves lit `t` ms into a pattern; lowers `wait` to the end of that step */
+uint8_t patternFrame(FlashPattern p, unsigned long t, long &wait)
+{
+  const FlashPatternDef &d  = PATTERNS[p];
+  uint16_t               in = t % d.cycleMs;
+  for (uint8_t i = 0; i < d.count; ++i) {
+    uint16_t len = fsMs(d.steps[i]);
+    if (in < len) {
+      if (len - in < wait) wait = len - in;
+      return FRAME_PATTERN | fsHalves(d.steps[i]);
+    }
+    in -= len;
+  }
+  return FRAME_PATTERN;
+}
+
+/* A group's pixels by strip half: cA / cB where lit, dark elsewhere */
+void paintHalves(Canvas to, const LampGroupMap &m, uint8_t halves, uint32_t cA, uint32_t cB)
+{
+  uint16_t mid = strips[m.strip]->numPixels() / 2;
+  for (uint8_t i = 0; i < m.count; ++i) {
+    uint8_t h = m.px[i] < mid ? H_A : H_B;
+    canvasSet(to, m.strip, m.px[i], (halves & h) ? (h == H_A ? cA : cB) : 0);
+  }
+}
+
+/* True while a flash pattern is showing: the head lamp stays on through
+   sleep, its pattern would not */
+bool patternRunning(uint32_t st)
+{
+  const uint8_t *pat = scene().pattern;
+  return (pat[STRIP_GYRO] && (st & ST_GYRO))   ||
+         (pat[STRIP_TURN] && (st & ST_HAZARD)) ||
+         (pat[STRIP_MAIN] && (st & ST_HEAD));
+}
+
+void patternSelect(StripId s, FlashPattern p)
+{
+  FrameGuard lock;
+  gScene.write([s, p](LampScene &sc){ sc.pattern[s] = p; });
+  composeInvalidate(s);
+}
+
+/* Paint one group as its owner wants it under state word `st`; no owner = dark */
+void renderGroup(Canvas to, LampGroup g, Feature f, uint8_t frame, uint32_t st,
+                 const Presets &p, const LampScene &sc)
+{
+  const LampGroupMap &m = GROUPS[g];
+  uint32_t            c = 0;
+
+  switch (f) {
+    case FT_SHOW:                              // painted by the show scripts
+      return;
+    case FT_GYRO:
+      if (frame & FRAME_PATTERN) paintHalves(to, m, frame, p.colGyroA, p.colGyroB);
+      else                       paintGyro(to, frame, p.colGyroA, p.colGyroB);
+      return;
+    case FT_LOW_BEAM:
+      for (uint8_t i = 0; i < m.count; ++i)
+        canvasSet(to, m.strip, m.px[i], LOW_BEAM_PX & _BV(m.px[i]) ? p.colHeadInit : 0);
+      return;
+    case FT_HEAD:
+      if (frame & FRAME_PATTERN) { paintHalves(to, m, frame, p.colHeadInit, p.colHeadInit); return; }
+      c = p.colHeadInit;
+      break;
+    case FT_TAIL:   c = p.colTailInit;                 break;
+    case FT_TURN_R:
+    case FT_TURN_L:
+    case FT_HAZARD:                            // first `frame` pixels lit
+      if (frame & FRAME_PATTERN) { paintHalves(to, m, frame, p.colTurnInit, p.colTurnInit); return; }
+      for (uint8_t i = 0; i < m.count; ++i)
+        canvasSet(to, m.strip, m.px[i], (SEQ_TURN ? i < frame : frame) ? p.colTurnInit : 0);
+      return;
+    case FT_PREVIEW:                           // steady, live colour if editing
+      if (g == GRP_GYRO) { paintGyro(to, true, p.colGyroA, p.colGyroB); return; }
+      c = g == GRP_HEAD ? (st & ST_CFG_HEAD_COL ? sc.cfgColour : p.colHeadInit)
+        : g == GRP_TAIL ? (st & ST_CFG_TAIL_COL ? sc.cfgColour : p.colTailInit)
+        :                 p.colTurnInit;
+      break;
+    default:
+      break;
+  }
+  for (uint8_t i = 0; i < m.count; ++i) canvasSet(to, m.strip, m.px[i], c);
+}
+
+/* ---------------------------------------------------------------------------
+ *  Analogue helpers
+ * ------------------------------------------------------------------------ */
+uint8_t potToBrightness(int raw)
+{
+  raw = constrain(raw, 0, 4095);
+  return map(raw, 0, 4095, 0, 255);            // full 8-bit range
+}
+uint32_t potToWhiteShade(int raw)
+{
+  raw = constrain(raw, 0, 4095);
+  byte pos = map(raw, 0, 4095, 0, 120);
+  return pxMain.Color(230 - pos, 240 - pos, 255 - pos / 3);
+}
+uint32_t potToRedShade(int raw)
+{
+  raw = constrain(raw, 0, 4095);
+  byte pos = map(raw, 0, 4095, 0, 100);
+  return pxMain.Color(255 - pos / 3, pos / 8, pos);
+}
+uint32_t potToAmberShade(int raw)
+{
+  raw = constrain(raw, 0, 4095);
+  byte pos = map(raw, 0, 4095, 0, 120);
+  return pxMain.Color(255 - pos / 5, 165 - pos / 2, 0);
+}
+
+/* ---------------------------------------------------------------------------
+ *  HSV helpers
+ * ------------------------------------------------------------------------ */
+uint32_t hsv(uint8_t h, uint8_t s, uint8_t v)
+{
+  const uint8_t *w  = HUE_WHEEL.rgb[h];
+  uint16_t       s1 = s + 1, v1 = v + 1;       // 8.8, 256 = 1.0
+  uint32_t       c  = 0;
+  for (uint8_t ch = 0; ch < 3; ++ch) {
+    uint8_t x = 255 - ((255 - w[ch]) * s1 >> 8);   // towards white
+    c = c << 8 | (x * v1 >> 8);
+  }
+  return c;
+}
+
+/* ---------------------------------------------------------------------------
+ *  Noise helpers
+ * ------------------------------------------------------------------------ */
+inline uint8_t lerp8(uint8_t a, uint8_t b, uint8_t f) { return a + ((int(b) - a) * f >> 8); }
+inline uint8_t qsub8(uint8_t a, uint8_t b)            { return a > b ? a - b : 0; }
+
+/* 3f² − 2f³ on 0…255 */
+inline uint8_t fade8(uint8_t f)
+{
+  uint16_t f2 = uint16_t(f) * f >> 8;
+  uint16_t f3 = f2 * f >> 8;
+  uint16_t s  = 3 * f2 - 2 * f3;
+  return s > 255 ? 255 : s;
+}
+
+/* x, y in lattice units 8.8 → 0…255 */
+uint8_t noise2(uint16_t x, uint16_t y)
+{
+  const uint8_t *p  = NOISE_PERM.p;
+  uint8_t        xi = x >> 8, yi = y >> 8;
+  uint8_t        fx = fade8(x), fy = fade8(y);
+  uint8_t        r0 = p[xi], r1 = p[uint8_t(xi + 1)];
+  uint8_t        a  = lerp8(p[uint8_t(r0 + yi)],     p[uint8_t(r1 + yi)],     fx);
+  uint8_t        b  = lerp8(p[uint8_t(r0 + yi + 1)], p[uint8_t(r1 + yi + 1)], fx);
+  return lerp8(a, b, fy);
+}
+
+/* Black → red → orange → yellow-white */
+uint32_t heatColour(uint8_t heat)
+{
+  uint8_t r = heat > 85  ? 255 : heat * 3;
+  uint8_t g = heat > 170 ? 255 : heat > 85  ? (heat - 85) * 3 : 0;
+  uint8_t b = heat > 170 ? (heat - 170) * 3 : 0;
+  return uint32_t(r) << 16 | g << 8 | b;
+}
+
+/* Every pixel of a strip, hue advancing by dHue per pixel (full s / v) */
+void fillRainbow(StripId s, uint8_t hue0, uint8_t dHue)
+{
+  for (uint16_t i = 0; i < strips[s]->numPixels(); ++i, hue0 += dHue) {
+    const uint8_t *w = HUE_WHEEL.rgb[hue0];
+    stripSet(s, i, uint32_t(w[0]) << 16 | w[1] << 8 | w[2]);
+  }
+}
+
+/* ---------------------------------------------------------------------------
+ *  Touch acquisition
+ *  -----------------
+ *  Bus time per sample (read + decode, incl. addressing):
+ *    cap.touched()    @ 100 kHz :  5 bytes ≈ 0.47 ms  → touch bits only
+ *    13 × filteredData() + 13 × baselineData() @ 100 kHz ≈ 12 ms
+ *    touchBurstRead() @ 400 kHz : 46 bytes ≈ 1.04 ms  → everything
+ *  Only touchPoll() bursts; touchState() returns the published mask.  The
+ *  measured figure is kept in TouchSample::busMicros and printed by 's',
+ *  flagged if a pass over all sensors would not fit TOUCH_POLL_US.
+ * ------------------------------------------------------------------------ */
+/* Auto-incrementing register read */
+bool mprRead(uint8_t addr, uint8_t reg, uint8_t *buf, uint8_t len)
+{
+  Wire.beginTransmission(addr);
+  Wire.write(reg);
+  if (Wire.endTransmission(false) != 0) return false;       // repeated start
+  if (Wire.requestFrom(addr, len) != len) return false;
+  for (uint8_t i = 0; i < len; ++i) buf[i] = Wire.read();
+  return true;
+}
+
+bool touchBurstRead(uint8_t addr, TouchSample &s)
 {
-  pxTurn.setPixelColor(2, phase ? c : 0);
-  pxTurn.setPixelColor(3, phase ? c : 0);
-  pxTurn.show();
+  uint8_t raw[MPR_BURST_LEN];
+
+  unsigned long t0 = micros();
+  if (!mprRead(addr, MPR_TOUCH_STATUS, raw, MPR_BURST_LEN)) return false;
+
+  s.tMicros   = t0;
+  s.busMicros = micros() - t0;
+  s.touched   = (raw[MPR_TOUCH_STATUS] | raw[MPR_TOUCH_STATUS + 1] << 8) & 0x1FFF;
+  s.oor       = (raw[MPR_OOR_STATUS]   | raw[MPR_OOR_STATUS   + 1] << 8) & 0x1FFF;
+  for (uint8_t e = 0; e < NUM_CHANNELS; ++e) {
+    s.filtered[e] = (raw[MPR_FILT_DATA + 2 * e] | raw[MPR_FILT_DATA + 2 * e + 1] << 8) & 0x03FF;
+    s.baseline[e] =  raw[MPR_BASELINE + e] << 2;
+  }
+  return true;
 }
-void toggleTurnL(bool phase, uint32_t c)
+
+/* One acquisition pass over every sensor that is due, then a single publish
+ * of the combined mask.  A failed burst keeps that sensor's previous bits. */
+void touchPoll()
 {
-  pxTurn.setPixelColor(0, phase ? c : 0);
-  pxTurn.setPixelColor(1, phase ? c : 0);
-  pxTurn.show();
+  static unsigned long tRefresh[NUM_TOUCH_SENSORS] = {};
+  unsigned long now  = millis();
+  touchBringUp(now);
+
+  uint32_t      irq  = gTouchIrq.exchange(0, std::memory_order_acq_rel);
+  uint8_t       up   = gSensorsUp.load(std::memory_order_relaxed);
+  TouchMask     mask = gTouchMask.load(std::memory_order_relaxed);
+
+  for (uint8_t n = 0; n < NUM_TOUCH_SENSORS; ++n) {
+    if (!(up & _BV(n))) continue;
+    bool due = TOUCH_SW_DETECT                       // needs every sample
+            || TOUCH_IRQ_PIN[n] == TOUCH_NO_IRQ
+            || (irq & _BV(n))
+            || now - tRefresh[n] >= TOUCH_REFRESH_MS;
+    if (!due) continue;
+
+    TouchSample s;
+    if (!touchBurstRead(MPR121_ADDR + n, s)) {
+      gTouchIrq.fetch_or(irq & _BV(n), std::memory_order_relaxed);  // retry
+      continue;
+    }
+    tRefresh[n] = now;
+    if (!(touchReady & _BV(n)) && calSettled(s)) {   // boot → first valid touch
+      touchReady |= _BV(n);
+      Serial.print(F("MPR121 0x"));
+      Serial.print(MPR121_ADDR + n, HEX);
+      Serial.print(F(" touch-ready at "));
+      Serial.print(millis());
+      Serial.println(F(" ms"));
+    }
+    if ((calPending & _BV(n)) && now - tCalStart[n] >= CAL_SETTLE_MS && !s.touched) {
+      calSave(n);
+      calPending &= ~_BV(n);
+    }
+#if TOUCH_SW_DETECT
+    uint16_t bits = swDetect(s, swDet[n]);
+#else
+    uint16_t bits = s.touched & TOUCH_MASK_ALL;
+#endif
+    statsUpdate(n, s, bits, now);
+#if INPUT_SLIDER
+    if (n == SLIDER_SENSOR) bits &= ~SLIDER_BITS;           // a position, not keys
+#endif
+    mask = (mask & ~(TouchMask(TOUCH_MASK_ALL) << (12 * n))) | (TouchMask(bits) << (12 * n));
+    gTouch[n].write([&s](TouchSample &d){ d = s; });
+#if INPUT_SLIDER
+    if (n == SLIDER_SENSOR) sliderUpdate(s);
+#endif
+  }
+  gTouchMask.store(mask, std::memory_order_release);
+  statsService();
 }
-void toggleHazard(bool phase, uint32_t c)
+
+/* Try every missing sensor whose back-off ran out (touch context) */
+void touchBringUp(unsigned long now)
 {
-  for (uint8_t i = 0; i < NUM_TURN_PIXELS; ++i)
-    pxTurn.setPixelColor(i, phase ? c : 0);
-  pxTurn.show();
+  static unsigned long tRetry[NUM_TOUCH_SENSORS] = {};
+  static uint16_t      wait[NUM_TOUCH_SENSORS]   = {};   // 0 = first attempt
+  uint8_t up = gSensorsUp.load(std::memory_order_relaxed);
+  if (up == SENSORS_ALL) return;
+
+  for (uint8_t n = 0; n < NUM_TOUCH_SENSORS; ++n) {
+    if ((up & _BV(n)) || (wait[n] && now - tRetry[n] < wait[n])) continue;
+
+    if (!cap[n].begin(MPR121_ADDR + n)) {
+      if (!wait[n]) {
+        Serial.print(F("MPR121 0x"));
+        Serial.print(MPR121_ADDR + n, HEX);
+        Serial.println(F(" not found – lights only, retrying"));
+      }
+      tRetry[n] = now;
+      wait[n]   = !wait[n]                        ? SENSOR_RETRY_MS
+                : wait[n] >= SENSOR_RETRY_MAX / 2 ? SENSOR_RETRY_MAX
+                :                                   uint16_t(wait[n] * 2);
+      continue;
+    }
+    Wire.setClock(TOUCH_I2C_HZ);            // after begin(), which resets it
+
+    tCalStart[n] = now;                     // touchPoll()'s clock, not ahead of it
+    if (!calLoad(n)) calPending |= _BV(n);
+    Serial.print(F("MPR121 0x"));
+    Serial.print(MPR121_ADDR + n, HEX);
+    Serial.print(calPending & _BV(n) ? F(" up, learning baselines at ")
+                                     : F(" up, cached calibration at "));
+    Serial.print(millis());
+    Serial.println(F(" ms"));
+
+    up |= _BV(n);
+    gSensorsUp.store(up, std::memory_order_release);
+  }
+}
+
+/* ---------------------------------------------------------------------------
+ *  Calibration cache
+ * ------------------------------------------------------------------------ */
+/* Seed sensor n from NVS.  False = nothing usable, sensor keeps learning. */
+bool calLoad(uint8_t n)
+{
+#if defined(ESP32)
+  char key[] = "cal0";
+  key[3] += n;
+
+  CalImage img;
+  Preferences nvs;
+  nvs.begin("mpr121", true);
+  bool ok = nvs.getBytesLength(key) == sizeof img &&
+            nvs.getBytes(key, &img, sizeof img) == sizeof img &&
+            img.version == CAL_VERSION;
+  nvs.end();
+  if (!ok) return false;
+
+  Adafruit_MPR121 &c = cap[n];
+  c.writeRegister(MPR_ECR, ECR_STOP);
+  c.writeRegister(MPR_AUTOCONFIG0, AUTOCONFIG_OFF);
+  for (uint8_t e = 0; e < NUM_CHANNELS; ++e) {
+    c.writeRegister(MPR_CDC0     + e, img.cdc[e]);
+    c.writeRegister(MPR_BASELINE + e, img.baseline[e]);
+  }
+  for (uint8_t i = 0; i < sizeof img.cdt; ++i)
+    c.writeRegister(MPR_CDT0 + i, img.cdt[i]);
+  c.writeRegister(MPR_ECR, ECR_RUN_CACHED);
+
+  /* Same shell, same surroundings?  Filtered data must sit on the baselines. */
+  delay(5);                                       // a few 1 ms samples
+  TouchSample s;
+  ok = touchBurstRead(MPR121_ADDR + n, s) && calSettled(s);
+  if (!ok) {
+    c.begin(MPR121_ADDR + n);                     // reset → relearn
+    Wire.setClock(TOUCH_I2C_HZ);                  // begin() dropped it to 100 kHz
+  }
+  return ok;
+#else
+  (void)n;
+  return false;
+#endif
 }
 
-void toggleHead(bool on, uint32_t c)
+/* Baselines within CAL_TOLERANCE of the data: touches can be trusted */
+bool calSettled(const TouchSample &s)
 {
-  static const uint8_t idx[] = {0,2,3,4,5,7};
-  for (uint8_t i : idx) pxMain.setPixelColor(i, on ? c : 0);
-  pxMain.show();
+  for (uint8_t e = 0; e < 12; ++e)
+    if (abs(int(s.filtered[e]) - int(s.baseline[e])) > CAL_TOLERANCE) return false;
+  return true;
+}
+
+/* Store sensor n's settled calibration (acquisition context) */
+void calSave(uint8_t n)
+{
+#if defined(ESP32)
+  char key[] = "cal0";
+  key[3] += n;
+
+  CalImage img;
+  img.version = CAL_VERSION;
+  if (!mprRead(MPR121_ADDR + n, MPR_BASELINE, img.baseline, sizeof img.baseline) ||
+      !mprRead(MPR121_ADDR + n, MPR_CDC0,     img.cdc,      sizeof img.cdc)      ||
+      !mprRead(MPR121_ADDR + n, MPR_CDT0,     img.cdt,      sizeof img.cdt))
+    return;
+
+  Preferences nvs;
+  nvs.begin("mpr121", false);
+  nvs.putBytes(key, &img, sizeof img);
+  nvs.end();
+  Serial.print(F("Touch: calibration cached at "));
+  Serial.print(millis());
+  Serial.println(F(" ms"));
+#else
+  (void)n;
+#endif
 }
-void toggleTail(bool on, uint32_t c)
+
+/* IRQ → mark that sensor for the next pass (reading status clears the line) */
+template<uint8_t N>
+void IRAM_ATTR touchIrq() { gTouchIrq.fetch_or(_BV(N), std::memory_order_relaxed); }
+
+void touchAttachIrqs()
 {
-  pxMain.setPixelColor(1, on ? c : 0);
-  pxMain.setPixelColor(6, on ? c : 0);
-  pxMain.show();
+  static void (*const isr[4])() = { touchIrq<0>, touchIrq<1>, touchIrq<2>, touchIrq<3> };
+  for (uint8_t n = 0; n < NUM_TOUCH_SENSORS; ++n) {
+    if (TOUCH_IRQ_PIN[n] == TOUCH_NO_IRQ) continue;
+    pinMode(TOUCH_IRQ_PIN[n], INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(TOUCH_IRQ_PIN[n]), isr[n], FALLING);
+  }
 }
-void toggleLowBeam(bool on, uint32_t c)
+
+/* Host-side touch decision from one sample; returns the electrode bits */
+uint16_t swDetect(const TouchSample &s, SwDetector *det)
 {
-  static const uint8_t idx[] = {0,2,5,7};
-  for (uint8_t i : idx) pxMain.setPixelColor(i, on ? c : 0);
-  pxMain.show();
+  uint16_t mask = 0;
+  for (uint8_t e = 0; e < 12; ++e) {
+    SwDetector &d = det[e];
+    int16_t  delta  = int16_t(s.baseline[e]) - int16_t(s.filtered[e]);
+    uint16_t thrOn  = (d.noiseQ4 * SW_NOISE_GAIN) >> 4;
+    if (thrOn < SW_TOUCH_MIN[e]) thrOn = SW_TOUCH_MIN[e];
+    uint16_t thrOff = thrOn >> 1;
+
+    if (!d.down) {
+      if (delta >= int16_t(thrOn)) {
+        if (++d.count >= SW_DEBOUNCE) { d.down = true; d.count = 0; }
+      } else {
+        d.count = 0;
+        if (delta < int16_t(thrOff)) {         // a finger on its way in is not noise
+          uint16_t mag = uint16_t(delta < 0 ? -delta : delta) << 4;
+          d.noiseQ4 += (int16_t(mag - d.noiseQ4)) >> SW_NOISE_SHIFT;
+        }
+      }
+    } else {
+      if (delta <= int16_t(thrOff)) {
+        if (++d.count >= SW_DEBOUNCE) { d.down = false; d.count = 0; }
+      } else {
+        d.count = 0;
+      }
+    }
+    if (d.down) mask |= _BV(e);
+  }
+  return mask;
 }
 
 /* ---------------------------------------------------------------------------
- *  Analogue helpers
+ *  Signal-quality analytics
  * ------------------------------------------------------------------------ */
-uint8_t potToBrightness(int raw)
+/* Fold one sample of sensor n into its statistics (acquisition context) */
+void statsUpdate(uint8_t n, const TouchSample &s, uint16_t bits, unsigned long now)
 {
-  raw = constrain(raw, 0, 4095);
-  return map(raw, 0, 4095, 0, 255);            // full 8-bit range
+  static uint16_t prevBits[NUM_TOUCH_SENSORS] = {};
+  uint16_t edges = bits ^ prevBits[n];
+  prevBits[n] = bits;
+
+  for (uint8_t e = 0; e < 12; ++e) {
+    ElectrodeStats &st = stats[n][e];
+    int32_t dQ4 = (int32_t(s.baseline[e]) - int32_t(s.filtered[e])) << 4;
+
+    if (st.base0N < STATS_BASE_N) {
+      if (touchReady & _BV(n)) {                           // not while the chip learns
+        st.base0Sum += s.baseline[e];
+        if (++st.base0N == STATS_BASE_N)
+          st.baseline0 = (st.base0Sum + STATS_BASE_N / 2) / STATS_BASE_N;
+      }
+    } else {
+      if (s.baseline[e] < st.baseMin) st.baseMin = s.baseline[e];
+      if (s.baseline[e] > st.baseMax) st.baseMax = s.baseline[e];
+      st.drift = int16_t(s.baseline[e]) - int16_t(st.baseline0);
+    }
+
+    if (bits & _BV(e)) {
+      st.touchMeanQ4 += (dQ4 - st.touchMeanQ4) >> STATS_SHIFT;
+    } else {
+      int32_t dev = dQ4 - st.noiseMeanQ4;                  // Q4
+      st.noiseMeanQ4 += dev >> STATS_SHIFT;
+      st.noiseVarQ8  += (int32_t(uint32_t(dev * dev) - st.noiseVarQ8)) >> STATS_SHIFT;
+    }
+
+    if (edges & bits & _BV(e)) {                           // touch edge
+      st.touches++;
+      if (st.releases && now - st.tRelease < BOUNCE_MS) st.bounces++;
+    } else if (edges & _BV(e)) {                           // release edge
+      st.releases++;
+      st.tRelease = now;
+    }
+  }
 }
-uint32_t potToWhiteShade(int raw)
+
+/* Answer a pending request from the loop with a consistent copy */
+void statsService()
 {
-  raw = constrain(raw, 0, 4095);
-  byte pos = map(raw, 0, 4095, 0, 120);
-  return pxMain.Color(230 - pos, 240 - pos, 255 - pos / 3);
+  uint8_t req = gStatsReq.load(std::memory_order_acquire);
+  if (req == STATS_REQUESTED) {
+    memcpy(statsSnap, stats, sizeof stats);
+    gStatsReq.store(STATS_READY, std::memory_order_release);
+  } else if (req == STATS_RESET) {
+    for (auto &row : stats) for (ElectrodeStats &st : row) st = ElectrodeStats();
+    gStatsReq.store(STATS_IDLE, std::memory_order_release);
+  }
 }
-uint32_t potToRedShade(int raw)
+
+/* One line per electrode; noise is the standard deviation, SNR = touch / noise */
+void statsPrint()
 {
-  raw = constrain(raw, 0, 4095);
-  byte pos = map(raw, 0, 4095, 0, 100);
-  return pxMain.Color(255 - pos / 3, pos / 8, pos);
+  Serial.println(F("S E  base min max drift noise  touch  SNR  T/R/B"));
+  for (uint8_t n = 0; n < NUM_TOUCH_SENSORS; ++n)
+    for (uint8_t e = 0; e < 12; ++e) {
+      const ElectrodeStats &st = statsSnap[n][e];
+      uint16_t sd10  = isqrt32(st.noiseVarQ8 * 100) >> 4;  // 0.1 counts
+      int32_t  touch = st.touchMeanQ4 >> 4;
+      Serial.print(n);               Serial.print(' ');
+      Serial.print(e);               Serial.print(' ');
+      bool     seen  = st.baseline0 != 0;
+      Serial.print(st.baseline0);    Serial.print(' ');
+      Serial.print(seen ? st.baseMin : 0);  Serial.print(' ');
+      Serial.print(st.baseMax);      Serial.print(' ');
+      Serial.print(st.drift);        Serial.print(' ');
+      Serial.print(sd10 / 10);       Serial.print('.');
+      Serial.print(sd10 % 10);       Serial.print(' ');
+      Serial.print(touch);           Serial.print(' ');
+      Serial.print(sd10 ? touch * 10 / sd10 : 0);  Serial.print(' ');
+      Serial.print(st.touches);      Serial.print('/');
+      Serial.print(st.releases);     Serial.print('/');
+      Serial.println(st.bounces);
+    }
+
+  uint8_t up = gSensorsUp.load(std::memory_order_acquire);
+  for (uint8_t n = 0; n < NUM_TOUCH_SENSORS; ++n) {
+    if (!(up & _BV(n))) continue;
+    TouchSample s = gTouch[n].snapshot();
+    Serial.print(F("Bus "));       Serial.print(n);
+    Serial.print(F(": "));         Serial.print(s.busMicros);
+    Serial.print(uint32_t(s.busMicros) * NUM_TOUCH_SENSORS > TOUCH_POLL_US
+                 ? F(" us/burst (over the poll period), ") : F(" us/burst, "));
+    Serial.print((micros() - s.tMicros) / 1000);
+    Serial.println(F(" ms ago"));
+  }
 }
-uint32_t potToAmberShade(int raw)
+
+/* Frame-edge commit lateness per render path; max − min is the jitter */
+void jitterPrint()
 {
-  raw = constrain(raw, 0, 4095);
-  byte pos = map(raw, 0, 4095, 0, 120);
-  return pxMain.Color(255 - pos / 5, 165 - pos / 2, 0);
+  static const char *const NAMES[NUM_JIT] = { "inline", "ahead" };
+  CommitJitter snap[NUM_JIT];
+  {
+    FrameGuard lock;
+    memcpy(snap, jitter, sizeof snap);
+  }
+  Serial.println(F("Commit   n  min  mean  max  jitter (us)"));
+  for (uint8_t k = 0; k < NUM_JIT; ++k) {
+    const CommitJitter &j = snap[k];
+    if (!j.n) continue;
+    Serial.print(NAMES[k]);                Serial.print(' ');
+    Serial.print(j.n);                     Serial.print(' ');
+    Serial.print(j.minUs);                 Serial.print(' ');
+    Serial.print(long(j.sumUs / j.n));     Serial.print(' ');
+    Serial.print(j.maxUs);                 Serial.print(' ');
+    Serial.println(j.maxUs - j.minUs);
+  }
+}
+
+void jitterReset()
+{
+  FrameGuard lock;
+  for (CommitJitter &j : jitter) j = CommitJitter();
+}
+
+/* Cost of the fused output encode on a scratch buffer, per pixel */
+void encodeBench()
+{
+  constexpr uint16_t ROUNDS = 1000;
+  PixelBuffer px(MAX_STRIP_PIXELS, WB_MAIN);
+  px.setBrightness(preset().brMainInit);
+  uint32_t c = scene().cfgColour;
+#if defined(ESP32)
+  uint32_t t0 = ESP.getCycleCount();
+#else
+  unsigned long t0 = micros();
+#endif
+  for (uint16_t r = 0; r < ROUNDS; ++r) {
+    for (uint8_t i = 0; i < MAX_STRIP_PIXELS; ++i) px.setPixelColor(i, c += 0x010305);
+    asm volatile("" : : "r"(px.getPixels()) : "memory");   // keep the stores
+  }
+#if defined(ESP32)
+  uint32_t t = ESP.getCycleCount() - t0;
+  Serial.print(F("Encode cycles/pixel x100: "));
+#else
+  unsigned long t = (micros() - t0) * 1000UL;   // ns
+  Serial.print(F("Encode ns/pixel x100: "));
+#endif
+  Serial.println(uint32_t(uint64_t(t) * 100 / (uint32_t(ROUNDS) * MAX_STRIP_PIXELS)));
+}
+
+uint16_t isqrt32(uint32_t v)
+{
+  uint32_t r = 0, bit = 1UL << 30;
+  while (bit > v) bit >>= 2;
+  while (bit) {
+    if (v >= r + bit) { v -= r + bit; r = (r >> 1) + bit; }
+    else              { r >>= 1; }
+    bit >>= 2;
+  }
+  return r;
+}
+
+/* ---------------------------------------------------------------------------
+ *  Serial commands
+ *  ---------------
+ *  s – electrode statistics and frame jitter
+ *  r – reset both
+ *  p<strip><n> – flash pattern n on a strip (strip 0 gyro, 1 turn, 2 main;
+ *                n 0 = the feature's own blink, 1–5 single … alternating)
+ *  t – tempo back to 120 BPM
+ *  e – time the pixel encoder
+ * ------------------------------------------------------------------------ */
+void serialCommands()
+{
+  static int8_t patStrip = -2;                 // 'p' parsing: -1 = strip next
+  while (Serial.available()) {
+    int c = Serial.read();
+    if (patStrip == -1) {
+      patStrip = (c >= '0' && c < '0' + NUM_STRIPS) ? c - '0' : -2;
+      continue;
+    }
+    if (patStrip >= 0) {
+      if (c >= '0' && c < '0' + NUM_PATTERNS) {
+        patternSelect(StripId(patStrip), FlashPattern(c - '0'));
+        Serial.print(F("Strip "));
+        Serial.print(patStrip);
+        Serial.print(F(" → pattern "));
+        Serial.println(c - '0');
+      }
+      patStrip = -2;
+      continue;
+    }
+    switch (c) {
+      case 's': gStatsReq.store(STATS_REQUESTED, std::memory_order_release); break;
+      case 'r': gStatsReq.store(STATS_RESET,     std::memory_order_release);
+                jitterReset();                                               break;
+      case 'p': patStrip = -1;                                               break;
+      case 't': tempoSet(TEMPO_BEAT_MS); Serial.println(F("Tempo 120 BPM"));   break;
+      case 'e': encodeBench();                                               break;
+      default:  break;
+    }
+  }
+  if (gStatsReq.load(std::memory_order_acquire) == STATS_READY) {
+    statsPrint();
+    jitterPrint();
+    gStatsReq.store(STATS_IDLE, std::memory_order_release);
+  }
+}
+
+/* Slider position from one sample (acquisition context) */
+void sliderUpdate(const TouchSample &s)
+{
+  int16_t d[SLIDER_COUNT];
+  uint8_t peak = 0;
+  for (uint8_t i = 0; i < SLIDER_COUNT; ++i) {
+    uint8_t e = SLIDER_FIRST + i;
+    d[i] = int16_t(s.baseline[e]) - int16_t(s.filtered[e]);
+    if (d[i] < 0) d[i] = 0;
+    if (d[i] > d[peak]) peak = i;
+  }
+  if (d[peak] < SLIDER_MIN_DELTA) return;        // finger off – hold position
+
+  /* Centroid of the peak and its two neighbours, in 1/256 electrode steps */
+  int32_t sum  = d[peak];
+  int32_t wsum = int32_t(d[peak]) * peak * 256;
+  if (peak > 0)                 { sum += d[peak - 1]; wsum += int32_t(d[peak - 1]) * (peak - 1) * 256; }
+  if (peak < SLIDER_COUNT - 1)  { sum += d[peak + 1]; wsum += int32_t(d[peak + 1]) * (peak + 1) * 256; }
+  int32_t pos256 = wsum / sum;                   // 0 … (COUNT-1)·256
+
+  gSliderPos.store(uint16_t(pos256 * SLIDER_MAX / ((SLIDER_COUNT - 1) * 256)),
+                   std::memory_order_relaxed);
+}
+
+/* Brightness / colour control: slider when fitted, otherwise the pot */
+int readAdjust()
+{
+#if INPUT_SLIDER
+  return gSliderPos.load(std::memory_order_relaxed);
+#else
+  return analogRead(POT_PIN);
+#endif
+}
+
+/* Park the slider on a stored brightness so a config loop opens on it */
+void sliderSeed(uint8_t br)
+{
+#if INPUT_SLIDER
+  gSliderPos.store(uint16_t((br * uint32_t(SLIDER_MAX) + 254) / 255), std::memory_order_relaxed);
+#else
+  (void)br;
+#endif
+}
+
+/* ---------------------------------------------------------------------------
+ *  Low-power sleep
+ * ------------------------------------------------------------------------ */
+/* Called once per loop: sleeps after IDLE_SLEEP_MS of inactivity */
+void powerIdleCheck(TouchMask touchNow)
+{
+  static unsigned long tActive = 0;
+  if (!LOW_POWER) return;
+  uint32_t st = stateSnapshot();
+  if (touchNow || (st & SLEEP_BLOCK) || patternRunning(st) ||
+      gSensorsUp.load(std::memory_order_acquire) != SENSORS_ALL)    // no wake source yet
+    tActive = millis();
+  else if (millis() - tActive >= IDLE_SLEEP_MS)      powerEnterSleep();
+}
+
+void powerEnterSleep()
+{
+#if defined(ESP32)
+#  if TOUCH_BACKGROUND
+  if (touchTask) {                                // park it between two passes
+    touchParkWaiter = xTaskGetCurrentTaskHandle();
+    gTouchPark.store(true, std::memory_order_release);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);      // bus is ours from here on
+  }
+#  endif
+  rtcState = stateSnapshot() & SLEEP_KEEP;
+  memcpy(rtcPresets, &preset(), sizeof(Presets));
+  memcpy(rtcPattern, scene().pattern, sizeof rtcPattern);
+  rtcMagic = RTC_MAGIC;
+
+  clearStrip(STRIP_GYRO);
+  clearStrip(STRIP_TURN);
+  clearStrip(STRIP_MAIN);
+
+  for (uint8_t n = 1; n < NUM_TOUCH_SENSORS; ++n)
+    cap[n].writeRegister(MPR_ECR, ECR_STOP);
+  cap[0].writeRegister(MPR_ECR,      ECR_STOP);   // config needs stop mode
+  cap[0].writeRegister(MPR_CONFIG2,  CONFIG2_SLEEP);
+  cap[0].writeRegister(MPR_PROX_TTH, PROX_TOUCH_THR);
+  cap[0].writeRegister(MPR_PROX_RTH, PROX_RELEASE_THR);
+  cap[0].writeRegister(MPR_ECR,      ECR_PROX_ONLY);
+  cap[0].touched();                               // release a pending IRQ
+
+  gpio_num_t irq = gpio_num_t(TOUCH_IRQ_PIN[0]);  // open drain: the digital
+  rtc_gpio_pullup_en(irq);                        // pull-up is off in deep sleep
+  rtc_gpio_pulldown_dis(irq);
+  esp_sleep_enable_ext0_wakeup(irq, 0);
+  esp_deep_sleep_start();                         // wakes through setup()
+#endif
+}
+
+/* Pick up state and presets after a proximity wake; false on a cold boot */
+bool powerRestore()
+{
+#if defined(ESP32)
+  if (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_EXT0 || rtcMagic != RTC_MAGIC)
+    return false;
+  rtcMagic = 0;
+  gPresets.write([](Presets &p){ memcpy(&p, rtcPresets, sizeof(Presets)); });
+  gScene.write([](LampScene &sc){
+    for (uint8_t s = 0; s < NUM_STRIPS; ++s)
+      sc.pattern[s] = rtcPattern[s] < NUM_PATTERNS ? rtcPattern[s] : uint8_t(PAT_DEFAULT);
+  });
+  stateSet(rtcState);
+  return true;
+#else
+  return false;
+#endif
+}
+
+/* Current electrode bits of all sensors – replaces cap.touched() everywhere */
+TouchMask touchState()
+{
+#if !TOUCH_BACKGROUND
+  static unsigned long tLast = 0;
+  if (micros() - tLast >= TOUCH_POLL_US) {
+    tLast = micros();
+    touchPoll();
+  }
+#endif
+  return gTouchMask.load(std::memory_order_acquire);
+}
+
+/* ---------------------------------------------------------------------------
+ *  Long-press brightness stepping
+ * ------------------------------------------------------------------------ */
+void longPressUpdate(TouchMask raw, unsigned long now)
+{
+  LongPress &lp = longPress;
+
+  if (raw != lp.key) {                         // released or changed key
+    if (lp.active) {
+      StripId s   = stripOfKey(lp.key);
+      uint8_t br  = brStage.level[s];
+      gPresets.write([s, br](Presets &p){
+        if      (s == STRIP_GYRO) p.brGyroInit = br;
+        else if (s == STRIP_TURN) p.brTurnInit = br;
+        else                      p.brMainInit = br;
+      });
+      brDir[s] = -brDir[s];
+    }
+    lp = LongPress();
+    if (raw == TK_GYRO || raw == TK_TURN_R || raw == TK_TURN_L ||
+        raw == TK_HEAD || raw == TK_TAIL) {
+      lp.key   = raw;
+      lp.tDown = now;
+    }
+    return;
+  }
+  if (!lp.key) return;
+
+  StripId s = stripOfKey(lp.key);
+
+  if (!lp.active) {
+    if (now - lp.tDown < LONG_PRESS_MS) return;
+    lp.active = true;
+    lp.tNext  = lp.tDown + LONG_PRESS_MS;
+    brStage.level[s] = s == STRIP_GYRO ? preset().brGyroInit
+                     : s == STRIP_TURN ? preset().brTurnInit
+                     :                   preset().brMainInit;
+
+    /* The press already toggled the lamp – make sure it ends up on */
+    uint32_t st = stateSnapshot();
+    if      (lp.key == TK_GYRO   && !(st & ST_GYRO))   { originSync(&LampScene::tOrgGyro); stateSet(ST_GYRO); }
+    else if (lp.key == TK_TURN_R && !(st & ST_TURN_R)) { turnSync(); stateUpdate(ST_TURN_L | ST_HAZARD, 0, ST_TURN_R); }
+    else if (lp.key == TK_TURN_L && !(st & ST_TURN_L)) { turnSync(); stateUpdate(ST_TURN_R | ST_HAZARD, 0, ST_TURN_L); }
+    else if (lp.key == TK_HEAD   && !(st & ST_HEAD))   { originSync(&LampScene::tOrgHead); stateUpdate(ST_LOW_BEAM, 0, ST_HEAD); }
+    else if (lp.key == TK_TAIL   && !(st & ST_TAIL))   { stateSet(ST_TAIL); }
+  }
+
+  if (long(now - lp.tNext) < 0) return;
+  brStep(s, brDir[s]);
+  lp.steps++;
+  /* On the repeat grid, so a late pass does not slip the next step; a
+     stalled loop drops the steps it missed instead of catching up */
+  lp.tNext += lp.steps < REPEAT_AFTER[0] ? REPEAT_MS[0]
+            : lp.steps < REPEAT_AFTER[1] ? REPEAT_MS[1] : REPEAT_MS[2];
+  if (long(now - lp.tNext) >= 0) lp.tNext = now;
+}
+
+/* O(1): move one level, bounce at the ends, mark the strip for commit */
+void brStep(StripId s, int8_t &dir)
+{
+  uint8_t &lvl = brStage.level[s];
+  if ((dir > 0 && lvl == 255) || (dir < 0 && lvl == 0)) dir = -dir;
+  lvl += dir;
+  brStage.dirty |= _BV(s);
+}
+
+/* Apply every dirty level once; the compositor repaints the strip */
+void brCommit()
+{
+  FrameGuard lock;
+  for (uint8_t s = 0; s < NUM_STRIPS; ++s) {
+    if (!(brStage.dirty & _BV(s))) continue;
+    stripBrightness(StripId(s), brStage.level[s]);
+    composeInvalidate(StripId(s));
+  }
+  brStage.dirty = 0;
+}
+
+/* ---------------------------------------------------------------------------
+ *  Tempo clock
+ * ------------------------------------------------------------------------ */
+/* Advance tempo time to real µs `now`; O(1).  The remainder below a tempo
+   ms is carried in frac, so ticks can be split any way.  The slew moves at
+   most 1/TEMPO_SLEW_DIV of the real time passed, and slowing down stops at
+   standing still. */
+unsigned long tempoTick(unsigned long now)
+{
+  constexpr uint32_t MS_Q16 = 1000UL << 16;
+  FrameGuard   lock;
+  TempoClock  &c  = tempo;
+  unsigned long dt = now - c.tReal;
+  if (!dt) return c.tt;
+
+  uint64_t adv = uint64_t(dt) * c.rate;        // tempo µs, Q16
+  if (c.slew) {
+    int64_t up   = (int64_t(dt) << 16) / TEMPO_SLEW_DIV;
+    int64_t down = up < int64_t(adv) ? up : int64_t(adv);
+    int64_t step = c.slew > up ? up : c.slew < -down ? -down : c.slew;
+    adv    += step;
+    c.slew -= step;
+  }
+  adv     += c.frac;
+  c.tReal  = now;
+  c.tt    += adv / MS_Q16;
+  c.frac   = adv % MS_Q16;
+  return c.tt;
+}
+
+unsigned long tempoNow()  { return tempoTick(micros()); }
+unsigned long tempoBeat() { unsigned long t = tempoNow(); return t - t % TEMPO_BEAT_MS; }
+
+/* New beat length in real ms; tempo time stays continuous */
+void tempoSet(uint16_t beatMs)
+{
+  FrameGuard lock;
+  tempoTick(micros());
+  tempo.rate = (uint32_t(TEMPO_BEAT_MS) << 16) / beatMs;
+  comp.dirty = GRP_ALL;                        // frame edges moved
+}
+
+/* One tap: median of the last intervals → tempo, tap → on the beat */
+void tempoTap(unsigned long tPress)
+{
+  TapTempo &tp = tapTempo;
+  if (tp.n && tPress - tp.tLast <= TAP_TIMEOUT_MS) {
+    tp.interval[(tp.n - 1) % TAP_HISTORY] = tPress - tp.tLast;
+    tp.n = tp.n < 2 * TAP_HISTORY ? tp.n + 1 : TAP_HISTORY + 1;   // same slot, no wrap
+  } else {
+    tp.n = 1;                                  // first tap of a new count
+  }
+  tp.tLast = tPress;
+  if (tp.n < 3) return;                        // two intervals at least
+
+  uint8_t  k = tp.n - 1 < TAP_HISTORY ? tp.n - 1 : TAP_HISTORY;
+  uint16_t v[TAP_HISTORY];
+  for (uint8_t i = 0; i < k; ++i) {            // insertion sort, k ≤ 5
+    uint16_t x = tp.interval[i];
+    uint8_t  j = i;
+    for (; j && v[j - 1] > x; --j) v[j] = v[j - 1];
+    v[j] = x;
+  }
+  uint16_t beat = k & 1 ? v[k / 2] : (v[k / 2 - 1] + v[k / 2]) / 2;
+  beat = constrain(beat, TEMPO_MIN_MS, TEMPO_MAX_MS);
+  tempoSet(beat);
+
+  /* Pull the nearest beat edge onto the press */
+  FrameGuard    lock;
+  unsigned long tt  = tempo.tt - ((millis() - tPress) * tempo.rate >> 16);
+  int32_t       off = tt % TEMPO_BEAT_MS;
+  tempo.slew = int64_t(off < TEMPO_BEAT_MS / 2 ? -off : TEMPO_BEAT_MS - off) * (1000 << 16);
+
+  Serial.print(F("Tempo "));
+  Serial.print(60000UL / beat);
+  Serial.println(F(" BPM"));
+}
+
+/* ---------------------------------------------------------------------------
+ *  Effect script scheduler
+ * ------------------------------------------------------------------------ */
+bool scriptStart(ScriptFn fn)
+{
+  for (Script &s : scripts) {
+    if (s.fn) continue;
+    s       = Script();
+    s.fn    = fn;
+    s.tWake = tempoNow();
+#if SCRIPT_COROUTINES
+    s.h     = fn(s).h;
+#endif
+    return true;
+  }
+  return false;                                // all slots busy
+}
+
+/* Resume every script whose deadline passed or whose event was posted */
+void scriptsRun(unsigned long now)
+{
+  uint32_t ev  = scriptEvents;
+  scriptEvents = 0;
+
+  for (Script &s : scripts) {
+    if (!s.fn) continue;
+    if (s.waitEv) {
+      if (!(s.waitEv & ev)) continue;
+      s.waitEv = 0;
+      s.tWake  = now;
+    } else if (long(now - s.tWake) < 0) {
+      continue;
+    }
+#if SCRIPT_COROUTINES
+    s.h.resume();
+    if (s.h.done()) { s.h.destroy(); s.fn = nullptr; }
+#else
+    if (!s.fn(s)) s.fn = nullptr;
+#endif
+  }
+}
+
+void scriptStop(ScriptFn fn)
+{
+  for (Script &s : scripts) {
+    if (s.fn != fn) continue;
+#if SCRIPT_COROUTINES
+    s.h.destroy();
+#endif
+    s.fn = nullptr;
+  }
+}
+
+void scriptsStopAll()
+{
+  for (Script &s : scripts) {
+#if SCRIPT_COROUTINES
+    if (s.fn) s.h.destroy();
+#endif
+    s.fn = nullptr;
+  }
+}
+
+void scriptPost(uint32_t ev) { scriptEvents |= ev; }
+
+/* ---------------------------------------------------------------------------
+ *  chordResolve()
+ *  --------------
+ *  Raw level in, one press event (single key or chord) out, 0 if none.
+ * ------------------------------------------------------------------------ */
+TouchMask chordResolve(TouchMask raw, unsigned long now)
+{
+  ChordResolver &r = chord;
+
+  r.consumed &= raw;                           // released keys may fire again
+  TouchMask fresh = raw & ~(r.held | r.singles | r.consumed);
+  if (fresh) {
+    if (!r.held) r.tFirst = now;
+    r.held |= fresh;
+  }
+
+  if (r.held) {
+    bool exact = false, canGrow = false;
+    for (TouchMask c : CHORDS) {
+      if (c == r.held)                    exact   = true;
+      else if ((c & r.held) == r.held)    canGrow = true;
+    }
+    if (exact) {                               // partner arrived in time
+      TouchMask ev = r.held;
+      r.consumed |= ev & raw;
+      r.held      = 0;
+      return ev;
+    }
+    if (!canGrow || (r.held & ~raw) || now - r.tFirst >= CHORD_SKEW_MS) {
+      r.singles |= r.held;                     // window closed or key lifted
+      r.held     = 0;
+    }
+  }
+
+  if (r.singles) {
+    TouchMask ev = r.singles & (~r.singles + 1);   // lowest key first
+    r.singles  &= ~ev;
+    r.consumed |= ev & raw;
+    return ev;
+  }
+  return 0;
 }
 
 /* Wait until a given electrode is released */
 void waitRelease(uint8_t electrode)
 {
-  while (cap.touched() & _BV(electrode)) delay(10);
+  while (touchState() & tk(electrode)) delay(10);
 }
 
 /* ---------------------------------------------------------------------------
- *  SHOW MODE – fancy demo lights (press electrode 6 to start)
+ *  SHOW MODE – fancy demo lights (tap electrode 6 to start / stop)
  * ------------------------------------------------------------------------ */
-void demoShowMode()
+/* Engine fire on the main strip: noise along the strip, drifting upwards */
+SCRIPT(showFire)
 {
-  /* Reset strips and brightness */
-  pxGyro.setBrightness(brGyroInit);
-  pxTurn.setBrightness(brTurnInit);
-  pxMain.setBrightness(brMainInit);
-  clearStrip(pxGyro);
-  clearStrip(pxTurn);
-  clearStrip(pxMain);
-
-  /* Sequencer */
-  bool running = true;
-  uint32_t tStart = millis();
-  uint8_t  order  = 0;     // 0-3 for the four centre pixels
-  while (running)
-  {
-    /* --- Gyro flash ---------------------------------------------------- */
-    bool phase = ((millis() - tStart) / 500) & 1;
-    toggleGyro(phase, colShowGyroA, colShowGyroB);
+  SCRIPT_BEGIN();
+  for (;;) {
+    {
+      uint16_t t = self.tWake;                 // tempo time, like the other scripts
+      for (uint8_t i = 0; i < NUM_HEADTAIL_PIXELS; ++i) {
+        uint8_t heat = noise2(i << 7, t << 1);             // ~2 lattice cells / s
+        heat = qsub8(heat, uint8_t(i == 0 || i == NUM_HEADTAIL_PIXELS - 1) << 6);
+        stripSet(STRIP_MAIN, i, heatColour(heat));
+      }
+      stripShow(STRIP_MAIN);
+    }
+    SCRIPT_SLEEP(NOISE_FRAME_MS);
+  }
+  SCRIPT_END();
+}
+
+/* Slow blue glow on the gyro ring */
+SCRIPT(showGlow)
+{
+  SCRIPT_BEGIN();
+  for (;;) {
+    {
+      uint16_t t = self.tWake;
+      for (uint8_t i = 0; i < NUM_GYRO_PIXELS; ++i) {
+        uint8_t v = noise2(i << 6, t >> 1);
+        stripSet(STRIP_GYRO, i, hsv(160 + (v >> 4), 255, 32 + (v * 223 >> 8)));
+      }
+      stripShow(STRIP_GYRO);
+    }
+    SCRIPT_SLEEP(NOISE_FRAME_MS);
+  }
+  SCRIPT_END();
+}
 
-    /* --- Turn & head chaser ------------------------------------------- */
-    toggleHazard(phase, colShowTurn);
+/* Gyro and turn strips flash together, 500 ms half-period */
+SCRIPT(showFlash)
+{
+  SCRIPT_BEGIN();
+  for (;;) {
+    toggleGyro(self.a, colShowGyroA, colShowGyroB);
+    toggleHazard(self.a, colShowTurn);
+    self.a = !self.a;
+    SCRIPT_SLEEP(500);
+  }
+  SCRIPT_END();
+}
 
-    /* middle pixel “bouncing” */
-    static const uint8_t centre[] = {1,2,5,6};
-    if (((millis() - tStart) / 500) % 2 == 0) {   // every second period
-      pxMain.setPixelColor(centre[order], colShowMain);
-      pxMain.setPixelColor(centre[(order + 3) % 4], 0);
-      pxMain.show();
-      order = (order + 1) & 3;
+/* Middle pixel “bouncing”: chase for one period, rest for the next */
+SCRIPT(showChaser)
+{
+  static const uint8_t centre[] = {1,2,5,6};
+  SCRIPT_BEGIN();
+  for (;;) {
+    for (self.i = 0; self.i < 25; ++self.i) {   // 25 × 20 ms
+      stripSet(STRIP_MAIN, centre[self.a], colShowMain);
+      stripSet(STRIP_MAIN, centre[(self.a + 3) & 3], 0);
+      stripShow(STRIP_MAIN);
+      self.a = (self.a + 1) & 3;
+      SCRIPT_SLEEP(20);
     }
+    SCRIPT_SLEEP(500);
+  }
+  SCRIPT_END();
+}
+
+/* Show-mode playlist: flash + chaser, then fire + glow, SHOW_ACT_MS each */
+SCRIPT(showDirector)
+{
+  SCRIPT_BEGIN();
+  for (;;) {
+    scriptStart(showFlash);
+    scriptStart(showChaser);
+    SCRIPT_SLEEP(SHOW_ACT_MS);
+    scriptStop(showFlash);
+    scriptStop(showChaser);
+    clearStrip(STRIP_TURN);
+
+    scriptStart(showFire);
+    scriptStart(showGlow);
+    SCRIPT_SLEEP(SHOW_ACT_MS);
+    scriptStop(showFire);
+    scriptStop(showGlow);
+    clearStrip(STRIP_GYRO);
+    clearStrip(STRIP_MAIN);
+  }
+  SCRIPT_END();
+}
 
-    if (cap.touched() == TK_SHOW) {
-      waitRelease(6);
-      running = false;
+/* All three strips as one wheel, turning a little every frame */
+SCRIPT(rainbow)
+{
+  SCRIPT_BEGIN();
+  for (;;) {
+    {
+      uint8_t h = self.a;
+      for (uint8_t s = 0; s < NUM_STRIPS; ++s) {
+        fillRainbow(StripId(s), h, RAINBOW_STEP);
+        stripShow(StripId(s));
+        h += strips[s]->numPixels() * RAINBOW_STEP;
+      }
     }
-    delay(20);
+    self.a += 2;
+    SCRIPT_SLEEP(RAINBOW_FRAME_MS);
+  }
+  SCRIPT_END();
+}
+
+/* Start / stop a full-strip effect (ST_SHOW, ST_RAINBOW); starting one
+   stops the other */
+void effectToggle(uint32_t bit)
+{
+  /* Reset strips and brightness */
+  stripBrightness(STRIP_GYRO, preset().brGyroInit);
+  stripBrightness(STRIP_TURN, preset().brTurnInit);
+  stripBrightness(STRIP_MAIN, preset().brMainInit);
+  clearStrip(STRIP_GYRO);
+  clearStrip(STRIP_TURN);
+  clearStrip(STRIP_MAIN);
+
+  scriptsStopAll();                            // compose() repaints the owners
+  if (!(stateToggle(bit, ST_EFFECTS & ~bit) & bit)) return;
+  if (bit == ST_SHOW) {
+    scriptStart(showDirector);
+  } else {
+    scriptStart(rainbow);
   }
-  /* Clean-up */
-  clearStrip(pxGyro);
-  clearStrip(pxTurn);
-  clearStrip(pxMain);
 }
@@ -0,0 +1,36 @@
+/* ---------------------------------------------------------------------------
+ *  Output stage cost per pixel: one frame of stripSet() + stripShow()
+ *  ------------------------------------------------------------------
+ *  bench_dither builds with LED_DITHER=1, bench_dither_off without.  The
+ *  frame paints every pixel and sends it; the difference between the two is
+ *  the 16-bit shadow plus the quantise-and-carry kernel.  Only show() runs
+ *  again on a 400 Hz refresh, so that line is the kernel's steady cost.
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include <chrono>
+
+int main()
+{
+  constexpr uint32_t ROUNDS = 200000;
+  constexpr double   PX     = double(ROUNDS) * NUM_HEADTAIL_PIXELS;
+  stripBrightness(STRIP_MAIN, 37);
+
+  uint32_t c = 0x3C8A11;
+  auto a = std::chrono::steady_clock::now();
+  for (uint32_t r = 0; r < ROUNDS; ++r) {
+    for (uint8_t i = 0; i < NUM_HEADTAIL_PIXELS; ++i) stripSet(STRIP_MAIN, i, c += 0x010305);
+    stripShow(STRIP_MAIN);
+    asm volatile("" : : "r"(pxMain.backend().wire) : "memory");
+  }
+  auto b = std::chrono::steady_clock::now();
+  for (uint32_t r = 0; r < ROUNDS; ++r) {
+    stripShow(STRIP_MAIN);
+    asm volatile("" : : "r"(pxMain.backend().wire) : "memory");
+  }
+  auto d = std::chrono::steady_clock::now();
+  printf("output stage (%s): frame %.2f ns per pixel, refresh %.2f ns per pixel\n",
+         LED_DITHER ? "dither" : "plain",
+         std::chrono::duration<double, std::nano>(b - a).count() / PX,
+         std::chrono::duration<double, std::nano>(d - b).count() / PX);
+  return 0;
+}
@@ -0,0 +1,2 @@
+/* bench_dither.cpp without LED_DITHER */
+#include "bench_dither.cpp"
@@ -0,0 +1,51 @@
+/* ---------------------------------------------------------------------------
+ *  LAMP_MODEL: filament step cost per pixel, and its step response
+ *  ---------------------------------------------------------------
+ *  Times lampStep() per channel over a spread of targets, then a whole
+ *  turn-strip stripShow() (every pixel a bulb) per pixel.  The response
+ *  line steps a filament from dark to full at the LAMP_FRAME_US rate and
+ *  reports when it passes 63 % (one time constant).
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include <chrono>
+
+static_assert(LAMP_MODEL, "build with -DLAMP_MODEL=1");
+
+int main()
+{
+  constexpr uint32_t N = 1 << 12, ROUNDS = 2000;
+  const uint32_t dt    = LAMP_FRAME_US;
+  const uint16_t aUp   = (dt << 15) / (dt + LAMP_TAU_UP_MS   * 1000UL);
+  const uint16_t aDown = (dt << 15) / (dt + LAMP_TAU_DOWN_MS * 1000UL);
+
+  static uint16_t y[N], target[N];
+  uint32_t r = 1;
+  for (uint32_t k = 0; k < N; ++k) target[k] = (r = r * 1664525u + 1013904223u) >> 16;
+
+  uint32_t sink = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t k = 0; k < ROUNDS; ++k)
+    for (uint32_t i = 0; i < N; ++i) sink += lampStep(y[i], target[i] ^ (k & 1 ? 0xFFFF : 0), aUp, aDown);
+  auto t1 = std::chrono::steady_clock::now();
+  asm volatile("" : : "r"(sink));
+  double perCh = std::chrono::duration<double, std::nano>(t1 - t0).count() / (double(N) * ROUNDS);
+
+  constexpr uint32_t SHOWS = 200000;
+  for (uint8_t i = 0; i < NUM_TURN_PIXELS; ++i) stripSet(STRIP_TURN, i, 0xFFA500);
+  auto t2 = std::chrono::steady_clock::now();
+  for (uint32_t k = 0; k < SHOWS; ++k) {
+    host::us += dt;                            // keep the filament moving
+    if (k % 40 == 0) for (uint8_t i = 0; i < NUM_TURN_PIXELS; ++i) stripSet(STRIP_TURN, i, k % 80 ? 0 : 0xFFA500);
+    stripShow(STRIP_TURN);
+  }
+  auto t3 = std::chrono::steady_clock::now();
+  double perPx = std::chrono::duration<double, std::nano>(t3 - t2).count() / (double(SHOWS) * NUM_TURN_PIXELS);
+
+  uint16_t f = 0, ms = 0;
+  while (f < 0xFFFF * 63 / 100) { lampStep(f, 0xFFFF, aUp, aDown); ms += dt / 1000; }
+
+  printf("lamp model: %.2f ns per channel step, turn strip show %.2f ns per pixel; "
+         "63 %% after %u ms (tau %u ms, %u ms steps)\n",
+         perCh, perPx, ms, LAMP_TAU_UP_MS, unsigned(dt / 1000));
+  return 0;
+}
@@ -0,0 +1,41 @@
+/* ---------------------------------------------------------------------------
+ *  noise2(): samples per second and the shape of its output
+ *  --------------------------------------------------------
+ *  Samples a drifting 8.8 lattice the way showFire() walks it, then prints
+ *  a 16-bin histogram of the values over a 1024 × 1024 patch (16 lattice
+ *  cells per axis × 64 steps per cell).
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include <chrono>
+
+int main()
+{
+  constexpr uint32_t N = 1 << 16, ROUNDS = 200;
+  uint32_t sink = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t k = 0; k < ROUNDS; ++k)
+    for (uint32_t i = 0; i < N; ++i) sink += noise2(uint16_t(i * 37), uint16_t(k * 11 + (i >> 4)));
+  auto t1 = std::chrono::steady_clock::now();
+  asm volatile("" : : "r"(sink));
+  double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / (double(N) * ROUNDS);
+  printf("noise2: %.2f ns per sample, %.0f M samples/s\n", ns, 1e3 / ns);
+
+  uint32_t bin[16] = {}, total = 0, lo = 255, hi = 0;
+  for (uint32_t y = 0; y < 1024; ++y)
+    for (uint32_t x = 0; x < 1024; ++x) {
+      uint8_t v = noise2(x << 2, y << 2);
+      bin[v >> 4]++;
+      total++;
+      if (v < lo) lo = v;
+      if (v > hi) hi = v;
+    }
+  uint32_t peak = 0;
+  for (uint32_t b : bin) if (b > peak) peak = b;
+  printf("noise2 histogram, %u samples, range %u…%u:\n", total, lo, hi);
+  for (uint8_t b = 0; b < 16; ++b) {
+    printf("  %3u-%3u %5.1f %% ", b * 16, b * 16 + 15, 100.0 * bin[b] / total);
+    for (uint32_t k = 0; k < bin[b] * 50 / peak; ++k) putchar('#');
+    putchar('\n');
+  }
+  return 0;
+}
@@ -0,0 +1,53 @@
+/* ---------------------------------------------------------------------------
+ *  Effect scripts: cost of one resume, and memory per script
+ *  ---------------------------------------------------------
+ *  100 scripts that sleep 1 ms each, so every scriptsRun() resumes all of
+ *  them.  Built as protothreads here and as C++20 coroutines in
+ *  bench_scripts_coro; the coroutine frame is counted through operator new.
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include <chrono>
+#include <new>
+
+static size_t heapBytes = 0;
+void *operator new(size_t n)
+{
+  heapBytes += n;
+  if (void *p = malloc(n)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept         { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+SCRIPT(tick)
+{
+  SCRIPT_BEGIN();
+  for (;;) {
+    self.i++;
+    SCRIPT_SLEEP(1);
+  }
+  SCRIPT_END();
+}
+
+int main()
+{
+  constexpr uint32_t N = 100, RUNS = 20000;
+  size_t h0 = heapBytes;
+  for (uint32_t k = 0; k < N; ++k) scriptStart(tick);
+  size_t frame = (heapBytes - h0) / N;
+
+  unsigned long t = tempoNow();
+  scriptsRun(t);
+  auto a = std::chrono::steady_clock::now();
+  for (uint32_t r = 1; r <= RUNS; ++r) scriptsRun(t + r);
+  auto b = std::chrono::steady_clock::now();
+
+  uint32_t resumes = 0;
+  for (uint32_t k = 0; k < N; ++k) resumes += scripts[k].i;
+  double ns = std::chrono::duration<double, std::nano>(b - a).count() / (resumes - N);
+  printf("scripts (%s): %.1f ns per resume over %u, %zu + %zu bytes per script\n",
+         SCRIPT_COROUTINES ? "coroutines" : "protothreads", ns, resumes - N,
+         sizeof(Script), frame);
+  scriptsStopAll();
+  return 0;
+}
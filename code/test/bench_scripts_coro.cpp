@@ -0,0 +1,2 @@
+/* bench_scripts.cpp built as C++20 coroutines */
+#include "bench_scripts.cpp"
@@ -0,0 +1,47 @@
+/* ---------------------------------------------------------------------------
+ *  SPI LED backend: symbol table check and encoder throughput
+ *  ----------------------------------------------------------
+ *  Decodes all 256 table entries back through the symbol rules (a 0 is one
+ *  high SPI bit, a 1 two, MSB first), then times encode() over a buffer
+ *  the size of a long strip.
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include <chrono>
+
+using Spi = SpiBackend<SPI_LED_BITS, SPI_LED_HZ>;
+
+int main()
+{
+  constexpr uint8_t Bits = SPI_LED_BITS;
+  uint16_t bad = 0;
+  for (uint16_t v = 0; v < 256; ++v) {
+    uint32_t bits = 0;
+    for (uint8_t k = 0; k < Bits; ++k) bits = bits << 8 | Spi::TABLE.sym[v][k];
+    uint8_t back = 0;
+    bool    ok   = true;
+    for (uint8_t b = 0; b < 8; ++b) {
+      uint8_t sym = bits >> (Bits * (7 - b)) & ((1u << Bits) - 1);
+      ok &= sym == 1u << (Bits - 1) || sym == 3u << (Bits - 2);
+      back = back << 1 | (sym == 3u << (Bits - 2));
+    }
+    bad += !ok || back != v;
+  }
+  printf("spi table: %u of 256 bytes decode back to themselves (%u-bit symbols)\n",
+         256 - bad, Bits);
+
+  constexpr uint16_t BYTES = 3 * 300;          // a 300-pixel strip
+  constexpr uint32_t ROUNDS = 200000;
+  static uint8_t w[BYTES], sym[BYTES * Bits];
+  uint32_t r = 1;
+  for (uint8_t &b : w) b = (r = r * 1664525u + 1013904223u) >> 24;
+  auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t k = 0; k < ROUNDS; ++k) {
+    w[k % BYTES] ^= uint8_t(k);
+    Spi::encode(sym, w, BYTES);
+    asm volatile("" : : "r"(sym) : "memory");
+  }
+  auto   t1 = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / (double(BYTES) * ROUNDS);
+  printf("spi encode: %.2f ns per wire byte, %.2f GB/s of input\n", ns, 1 / ns);
+  return bad ? 1 : 0;
+}
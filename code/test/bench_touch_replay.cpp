@@ -0,0 +1,148 @@
+/* ---------------------------------------------------------------------------
+ *  Touch detection replay: swDetect() against the MPR121's own decision
+ *  -------------------------------------------------------------------
+ *  A recording of 12 electrodes at the 1 kHz burst rate is replayed through
+ *  both detectors.  Without an argument the recording is synthesised from
+ *  a fixed seed: baseline drift, Gaussian noise, short EMI spikes and finger
+ *  touches that ramp in over 5-25 ms.  With a path, lines of
+ *  "electrode,filtered,baseline,truth" (truth 0/1, one sample per line per
+ *  electrode, in time order) are replayed instead.
+ *
+ *  The chip is modelled with the thresholds Adafruit_MPR121::begin() sets
+ *  (touch 12, release 6) and no debounce.  Latency is measured from the
+ *  first sample of true contact; a detected touch that starts outside a
+ *  true contact is a false trigger.
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+struct Frame { uint16_t filtered[12], baseline[12], truth; };
+
+static std::vector<Frame> synthesise(uint32_t ms)
+{
+  std::mt19937 rng(20240611);
+  std::normal_distribution<float>      noise(0.f, 1.2f);
+  std::uniform_int_distribution<int>   gap(300, 3000), hold(80, 400), ramp(5, 25), amp(18, 45);
+  std::uniform_int_distribution<int>   spikeAmp(8, 16), spikeLen(1, 3);
+  std::uniform_real_distribution<float> u(0.f, 1.f);
+
+  std::vector<Frame> rec(ms);
+  for (uint8_t e = 0; e < 12; ++e) {
+    float    base = 690 + 10 * e;
+    uint32_t t    = gap(rng);
+    std::vector<float> finger(ms, 0.f);
+    std::vector<bool>  truth(ms, false);
+    while (t + 600 < ms) {                     // touch: ramp, hold, release ramp
+      int r = ramp(rng), h = hold(rng), a = amp(rng);
+      for (int i = 0; i < r; ++i)     finger[t + i]         = a * float(i + 1) / r;
+      for (int i = 0; i < h; ++i)     finger[t + r + i]     = a;
+      for (int i = 0; i < r; ++i)     finger[t + r + h + i] = a * float(r - i - 1) / r;
+      for (int i = 0; i < r + h; ++i) truth[t + i]          = true;
+      t += r + h + r + gap(rng);
+    }
+    int spike = 0, spikeLeft = 0;
+    for (uint32_t i = 0; i < ms; ++i) {
+      base += 0.002f * (u(rng) - 0.5f);        // slow drift
+      if (!spikeLeft && u(rng) < 1.f / 20000) { spike = spikeAmp(rng); spikeLeft = spikeLen(rng); }
+      float f = base - finger[i] + noise(rng) - (spikeLeft ? spike : 0);
+      if (spikeLeft) spikeLeft--;
+      rec[i].filtered[e] = uint16_t(std::clamp(f, 0.f, 1023.f));
+      rec[i].baseline[e] = uint16_t(base);     // the chip's filter tracks it
+      if (truth[i]) rec[i].truth |= _BV(e);
+    }
+  }
+  return rec;
+}
+
+static std::vector<Frame> load(const char *path)
+{
+  std::vector<Frame> rec;
+  std::vector<size_t> next(12, 0);
+  FILE *f = fopen(path, "r");
+  if (!f) { perror(path); exit(1); }
+  unsigned e, fl, bl, tr;
+  while (fscanf(f, "%u,%u,%u,%u", &e, &fl, &bl, &tr) == 4 && e < 12) {
+    size_t i = next[e]++;
+    if (rec.size() <= i) rec.resize(i + 1, Frame{});
+    rec[i].filtered[e] = fl;
+    rec[i].baseline[e] = bl;
+    if (tr) rec[i].truth |= _BV(e);
+  }
+  fclose(f);
+  return rec;
+}
+
+struct Score {
+  const char *name;
+  uint32_t touches = 0, detected = 0, falses = 0;
+  std::vector<uint32_t> latency;
+  uint16_t prev = 0, prevTruth = 0;
+  uint32_t onset[12] = {};
+  bool     hit[12]   = {};
+
+  void step(uint32_t t, uint16_t bits, uint16_t truth)
+  {
+    for (uint8_t e = 0; e < 12; ++e) {
+      uint16_t b = _BV(e);
+      if ((truth & b) && !(prevTruth & b)) { onset[e] = t; hit[e] = false; touches++; }
+      if ((bits & b) && !(prev & b)) {
+        if ((truth & b) && !hit[e]) { hit[e] = true; detected++; latency.push_back(t - onset[e]); }
+        else if (!(truth & b))      falses++;
+      }
+    }
+    prev = bits; prevTruth = truth;
+  }
+
+  void print(double minutes)
+  {
+    std::sort(latency.begin(), latency.end());
+    double mean = 0;
+    for (uint32_t l : latency) mean += l;
+    mean = latency.empty() ? 0 : mean / latency.size();
+    printf("%-5s  %5u/%-5u  %6.2f  %3u  %3u   %7.2f\n", name, detected, touches, mean,
+           latency.empty() ? 0 : latency[latency.size() * 95 / 100],
+           latency.empty() ? 0 : latency.back(), falses / minutes);
+  }
+};
+
+int main(int argc, char **argv)
+{
+  std::vector<Frame> rec = argc > 1 ? load(argv[1]) : synthesise(10 * 60 * 1000);
+  double minutes = rec.size() / 60000.0;
+
+  Score sw{ "sw" }, chip{ "chip" };
+  SwDetector det[12];
+  uint16_t   chipDown = 0;
+  TouchSample s;
+  auto t0 = std::chrono::steady_clock::now();
+  std::chrono::nanoseconds swTime{ 0 };
+
+  for (uint32_t t = 0; t < rec.size(); ++t) {
+    const Frame &f = rec[t];
+    for (uint8_t e = 0; e < 12; ++e) {
+      s.filtered[e] = f.filtered[e];
+      s.baseline[e] = f.baseline[e] & ~3;      // register holds bits 9:2
+      int delta = f.baseline[e] - f.filtered[e];
+      if (!(chipDown & _BV(e)) && delta > 12) chipDown |=  _BV(e);
+      else if ((chipDown & _BV(e)) && delta < 6) chipDown &= ~_BV(e);
+    }
+    auto a = std::chrono::steady_clock::now();
+    uint16_t bits = swDetect(s, det);
+    swTime += std::chrono::steady_clock::now() - a;
+    sw.step(t, bits, f.truth);
+    chip.step(t, chipDown, f.truth);
+  }
+  (void)t0;
+
+  printf("Replay: %zu samples x 12 electrodes (%.1f min)%s\n", rec.size(), minutes,
+         argc > 1 ? "" : ", synthetic");
+  printf("        found        latency ms      false\n");
+  printf("                     mean p95  max   /min\n");
+  chip.print(minutes);
+  sw.print(minutes);
+  printf("swDetect: %.1f ns per 12-electrode sample on this host\n",
+         double(swTime.count()) / rec.size());
+  return 0;
+}
@@ -0,0 +1,32 @@
+/* ---------------------------------------------------------------------------
+ *  Minimal test helpers for the host harness
+ * ------------------------------------------------------------------------ */
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+
+inline int checkFailures = 0;
+
+#define CHECK(cond)                                                         \
+  do {                                                                      \
+    if (!(cond)) {                                                          \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      checkFailures++;                                                      \
+    }                                                                       \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                                      \
+  do {                                                                      \
+    long long va_ = (long long)(a), vb_ = (long long)(b);                   \
+    if (va_ != vb_) {                                                       \
+      fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n",     \
+              __FILE__, __LINE__, #a, #b, va_, vb_);                        \
+      checkFailures++;                                                      \
+    }                                                                       \
+  } while (0)
+
+inline int checkDone(const char *name)
+{
+  printf("%s: %s\n", name, checkFailures ? "FAIL" : "ok");
+  return checkFailures ? 1 : 0;
+}
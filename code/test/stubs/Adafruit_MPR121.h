@@ -0,0 +1,28 @@
+#pragma once
+#include "Wire.h"
+
+/* begin() resets the chip and, like the library, sets the bus to 100 kHz */
+struct Adafruit_MPR121 {
+  uint8_t addr = 0x5A;
+  bool begin(uint8_t a = 0x5A)
+  {
+    addr = a;
+    Wire.setClock(100000);
+    host::i2cCost(2 + 2 * 20);                 // soft reset + default config
+    host::Mpr *m = host::mprAt(a);
+    if (m && m->present && m->model) m->reset(host::us);
+    return m && m->present;
+  }
+  uint16_t touched()
+  {
+    uint8_t b[2];
+    Wire.beginTransmission(addr); Wire.write(0); Wire.endTransmission(false);
+    Wire.requestFrom(addr, 2);
+    b[0] = Wire.read(); b[1] = Wire.read();
+    return (b[0] | b[1] << 8) & 0x0FFF;
+  }
+  void writeRegister(uint8_t reg, uint8_t v)
+  {
+    Wire.beginTransmission(addr); Wire.write(reg); Wire.write(v); Wire.endTransmission();
+  }
+};
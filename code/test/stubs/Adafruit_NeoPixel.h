@@ -0,0 +1,16 @@
+#pragma once
+#include "Arduino.h"
+#define NEO_GRB    0x52
+#define NEO_KHZ800 0x0000
+typedef uint16_t neoPixelType;
+
+/* Pixel array plus a count of show() calls */
+struct Adafruit_NeoPixel {
+  std::vector<uint8_t> px;
+  uint32_t             shows = 0;
+  Adafruit_NeoPixel(uint16_t n, int16_t, neoPixelType) : px(3 * n) {}
+  void     begin() {}
+  void     show()  { shows++; }
+  uint16_t numPixels() const { return uint16_t(px.size() / 3); }
+  uint8_t *getPixels() { return px.data(); }
+};
@@ -0,0 +1,106 @@
+#pragma once
+#include "host.h"
+
+typedef uint8_t byte;
+typedef bool    boolean;
+class __FlashStringHelper;
+#define F(s)           (reinterpret_cast<const __FlashStringHelper *>(s))
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define DEC            10
+#define HEX            16
+#define INPUT          0
+#define OUTPUT         1
+#define INPUT_PULLUP   2
+#define FALLING        2
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+inline unsigned long micros() { return (unsigned long)host::us; }
+inline unsigned long millis() { return (unsigned long)(host::us / 1000); }
+inline void delay(unsigned long ms)             { host::advanceMs(ms); }
+inline void delayMicroseconds(unsigned int d)   { host::advance(d); }
+inline int  analogRead(uint8_t)                 { return host::analogValue; }
+inline void pinMode(uint8_t, uint8_t)           {}
+inline int  digitalPinToInterrupt(int p)        { return p; }
+namespace host {
+inline void (*isr[64])() = {};
+inline void irq(int pin) { if (isr[pin]) isr[pin](); }   // falling edge on pin
+}
+inline void attachInterrupt(int pin, void (*f)(), int) { host::isr[pin] = f; }
+inline long map(long x, long inLo, long inHi, long outLo, long outHi)
+{
+  return (x - inLo) * (outHi - outLo) / (inHi - inLo) + outLo;
+}
+
+struct HostSerial {
+  void begin(long) {}
+  int  available()   { return int(host::serialIn.size()); }
+  int  read()
+  {
+    if (host::serialIn.empty()) return -1;
+    int c = (uint8_t)host::serialIn[0];
+    host::serialIn.erase(0, 1);
+    return c;
+  }
+  void put(const char *s) { host::serialOut += s; if (host::echo) fputs(s, stdout); }
+  void print(const char *s)                { put(s); }
+  void print(const __FlashStringHelper *s) { put(reinterpret_cast<const char *>(s)); }
+  void print(char c)                       { char b[2] = { c, 0 }; put(b); }
+  void print(long long v, int base = DEC)
+  {
+    char b[32];
+    snprintf(b, sizeof b, base == HEX ? "%llX" : "%lld", v);
+    put(b);
+  }
+  void print(unsigned long long v, int base = DEC)
+  {
+    char b[32];
+    snprintf(b, sizeof b, base == HEX ? "%llX" : "%llu", v);
+    put(b);
+  }
+  void print(int v, int base = DEC)           { print((long long)v, base); }
+  void print(long v, int base = DEC)          { print((long long)v, base); }
+  void print(unsigned v, int base = DEC)      { print((unsigned long long)v, base); }
+  void print(unsigned long v, int base = DEC) { print((unsigned long long)v, base); }
+  void print(uint8_t v, int base = DEC)       { print((unsigned long long)v, base); }
+  void print(uint16_t v, int base = DEC)      { print((unsigned long long)v, base); }
+  void print(int16_t v, int base = DEC)       { print((long long)v, base); }
+  void print(double v)                        { char b[32]; snprintf(b, sizeof b, "%.2f", v); put(b); }
+  void println()                              { put("\n"); }
+  template<typename T> void println(T v)            { print(v); println(); }
+  template<typename T> void println(T v, int base)  { print(v, base); println(); }
+};
+inline HostSerial Serial;
+
+#if defined(ESP32)
+/* FreeRTOS: one simulated context, so locks are no-ops and tasks do not run */
+typedef uint32_t TickType_t;
+typedef void   (*TaskFunction_t)(void *);
+typedef void    *TaskHandle_t;
+typedef int      BaseType_t;
+typedef void    *SemaphoreHandle_t;
+#define pdMS_TO_TICKS(x)  (x)
+#define pdTRUE            1
+#define pdFALSE           0
+#define portMAX_DELAY     0xFFFFFFFF
+#define tskNO_AFFINITY    0x7FFFFFFF
+inline TickType_t        xTaskGetTickCount()                       { return millis(); }
+inline void              vTaskDelayUntil(TickType_t *t, TickType_t d) { *t += d; }
+inline void              vTaskDelay(TickType_t d)                  { delay(d); }
+inline void              vTaskSuspend(TaskHandle_t)                {}
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex()          { return (void *)1; }
+inline BaseType_t        xSemaphoreTakeRecursive(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+inline BaseType_t        xSemaphoreGiveRecursive(SemaphoreHandle_t) { return pdTRUE; }
+inline uint32_t          ulTaskNotifyTake(BaseType_t, TickType_t)  { return 1; }
+inline BaseType_t        xTaskNotifyGive(TaskHandle_t)             { return pdTRUE; }
+inline TaskHandle_t      xTaskGetCurrentTaskHandle()               { return nullptr; }
+inline BaseType_t        xTaskCreatePinnedToCore(TaskFunction_t, const char *, uint32_t, void *,
+                                                 unsigned, TaskHandle_t *h, BaseType_t)
+{
+  if (h) *h = (void *)1;
+  return pdTRUE;
+}
+
+struct EspClass { uint32_t getCycleCount() { return uint32_t(host::us * 240); } };
+inline EspClass ESP;
+#endif
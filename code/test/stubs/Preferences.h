@@ -0,0 +1,27 @@
+#pragma once
+#include "Arduino.h"
+
+/* NVS as a map that outlives the sketch's objects */
+struct Preferences {
+  std::string ns;
+  bool   begin(const char *name, bool = false) { ns = name; return true; }
+  void   end() {}
+  size_t getBytesLength(const char *key)
+  {
+    auto it = host::nvs.find(ns + "/" + key);
+    return it == host::nvs.end() ? 0 : it->second.size();
+  }
+  size_t getBytes(const char *key, void *buf, size_t maxLen)
+  {
+    auto it = host::nvs.find(ns + "/" + key);
+    if (it == host::nvs.end() || it->second.size() > maxLen) return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+  }
+  size_t putBytes(const char *key, const void *v, size_t len)
+  {
+    const uint8_t *p = static_cast<const uint8_t *>(v);
+    host::nvs[ns + "/" + key].assign(p, p + len);
+    return len;
+  }
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include "Arduino.h"
+
+/* Register-file I2C: write(reg) sets the pointer, reads auto-increment */
+struct TwoWire {
+  uint8_t addr = 0, ptr = 0, txLen = 0;
+  uint8_t tx[8] = {};
+  bool    reading = false;
+
+  void   begin() {}
+  void   setClock(uint32_t hz)          { host::i2cHz = hz; }
+  void   beginTransmission(uint8_t a)   { addr = a; txLen = 0; }
+  size_t write(uint8_t b)               { if (txLen < sizeof tx) tx[txLen++] = b; return 1; }
+  uint8_t endTransmission(bool = true)
+  {
+    host::i2cCost(1 + txLen);
+    host::Mpr *m = host::mprAt(addr);
+    if (!m || !m->present) return 2;           // address NACK
+    if (txLen) ptr = tx[0];
+    for (uint8_t i = 1; i < txLen; ++i) m->onWrite(ptr++, tx[i], host::us);
+    return 0;
+  }
+  uint8_t requestFrom(uint8_t a, uint8_t len)
+  {
+    host::i2cCost(1 + len);
+    host::Mpr *m = host::mprAt(a);
+    if (!m || !m->present) return 0;
+    m->reads++;
+    m->sync(host::us);
+    addr = a;
+    return len;
+  }
+  int read() { host::Mpr *m = host::mprAt(addr); return m ? m->reg[ptr++] : -1; }
+};
+inline TwoWire Wire;
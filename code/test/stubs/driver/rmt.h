@@ -0,0 +1,39 @@
+#pragma once
+#include "../esp_sleep.h"
+
+/* RMT: rmt_write_sample runs the installed translator; the items of the last
+ * write per channel are kept for decoding */
+typedef enum { RMT_CHANNEL_0, RMT_CHANNEL_MAX = 8 } rmt_channel_t;
+typedef struct {
+  union {
+    struct { uint32_t duration0 : 15; uint32_t level0 : 1; uint32_t duration1 : 15; uint32_t level1 : 1; };
+    uint32_t val;
+  };
+} rmt_item32_t;
+typedef struct { int rmt_mode; rmt_channel_t channel; gpio_num_t gpio_num; uint8_t clk_div; uint8_t mem_block_num; } rmt_config_t;
+#define RMT_DEFAULT_CONFIG_TX(gpio, ch) rmt_config_t{ 0, ch, gpio, 80, 1 }
+typedef void (*sample_to_rmt_t)(const void *, rmt_item32_t *, size_t, size_t, size_t *, size_t *);
+
+namespace host {
+struct RmtChannel { sample_to_rmt_t tr = nullptr; std::vector<rmt_item32_t> items; uint32_t writes = 0; };
+inline RmtChannel rmt[RMT_CHANNEL_MAX];
+}
+
+inline esp_err_t rmt_config(const rmt_config_t *)                        { return 0; }
+inline esp_err_t rmt_driver_install(rmt_channel_t, size_t, int)          { return 0; }
+inline esp_err_t rmt_translator_init(rmt_channel_t ch, sample_to_rmt_t f) { host::rmt[ch].tr = f; return 0; }
+inline esp_err_t rmt_write_sample(rmt_channel_t ch, const uint8_t *src, size_t n, bool)
+{
+  host::RmtChannel &c = host::rmt[ch];
+  c.items.clear();
+  c.writes++;
+  size_t done = 0;
+  while (done < n) {                           // the driver refills in 8-byte chunks
+    rmt_item32_t buf[64];
+    size_t used = 0, num = 0;
+    c.tr(src + done, buf, n - done, 64, &used, &num);
+    c.items.insert(c.items.end(), buf, buf + num);
+    done += used;
+  }
+  return 0;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include "../esp_sleep.h"
+
+/* RTC IO: the pulls that hold a pin through deep sleep, one bit per GPIO */
+namespace host {
+inline uint64_t rtcPullup = 0, rtcPulldown = 0;
+}
+inline esp_err_t rtc_gpio_pullup_en(gpio_num_t p)    { host::rtcPullup   |=  1ull << p; return 0; }
+inline esp_err_t rtc_gpio_pullup_dis(gpio_num_t p)   { host::rtcPullup   &= ~(1ull << p); return 0; }
+inline esp_err_t rtc_gpio_pulldown_en(gpio_num_t p)  { host::rtcPulldown |=  1ull << p; return 0; }
+inline esp_err_t rtc_gpio_pulldown_dis(gpio_num_t p) { host::rtcPulldown &= ~(1ull << p); return 0; }
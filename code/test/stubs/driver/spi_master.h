@@ -0,0 +1,41 @@
+#pragma once
+#include "../Arduino.h"
+
+/* SPI master: queued transactions complete at once; the MOSI bytes of the
+ * last one per host are kept for decoding */
+typedef int esp_err_t;
+typedef enum { SPI1_HOST, SPI2_HOST, SPI3_HOST } spi_host_device_t;
+#define SPI_DMA_CH_AUTO 3
+typedef struct { int mosi_io_num, miso_io_num, sclk_io_num, quadwp_io_num, quadhd_io_num, max_transfer_sz; uint32_t flags; } spi_bus_config_t;
+typedef struct { uint8_t mode; int clock_speed_hz; int spics_io_num; uint32_t flags; int queue_size; } spi_device_interface_config_t;
+typedef struct { uint32_t flags; size_t length; const void *tx_buffer; void *rx_buffer; } spi_transaction_t;
+typedef struct spi_device_t *spi_device_handle_t;
+
+namespace host {
+struct SpiHost { int hz = 0; std::vector<uint8_t> mosi; uint32_t writes = 0; spi_transaction_t *pending = nullptr; };
+inline SpiHost spi[3];
+}
+struct spi_device_t { spi_host_device_t host; };
+
+inline esp_err_t spi_bus_initialize(spi_host_device_t, const spi_bus_config_t *, int) { return 0; }
+inline esp_err_t spi_bus_add_device(spi_host_device_t h, const spi_device_interface_config_t *c,
+                                    spi_device_handle_t *d)
+{
+  host::spi[h].hz = c->clock_speed_hz;
+  *d = new spi_device_t{ h };
+  return 0;
+}
+inline esp_err_t spi_device_queue_trans(spi_device_handle_t d, spi_transaction_t *t, uint32_t)
+{
+  host::SpiHost &s = host::spi[d->host];
+  const uint8_t *p = static_cast<const uint8_t *>(t->tx_buffer);
+  s.mosi.assign(p, p + t->length / 8);
+  s.writes++;
+  s.pending = t;
+  return 0;
+}
+inline esp_err_t spi_device_get_trans_result(spi_device_handle_t d, spi_transaction_t **t, uint32_t)
+{
+  *t = host::spi[d->host].pending;
+  return 0;
+}
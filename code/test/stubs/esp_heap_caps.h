@@ -0,0 +1,4 @@
+#pragma once
+#include <stdlib.h>
+#define MALLOC_CAP_DMA 8
+inline void *heap_caps_malloc(size_t n, unsigned) { return malloc(n); }
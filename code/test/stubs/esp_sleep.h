@@ -0,0 +1,15 @@
+#pragma once
+#include "Arduino.h"
+typedef int gpio_num_t;
+typedef int esp_err_t;
+typedef enum { ESP_SLEEP_WAKEUP_UNDEFINED, ESP_SLEEP_WAKEUP_EXT0 = 2 } esp_sleep_wakeup_cause_t;
+inline esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t, int) { return 0; }
+inline esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause()
+{
+  return esp_sleep_wakeup_cause_t(host::wakeCause);
+}
+[[noreturn]] inline void esp_deep_sleep_start()
+{
+  if (host::onDeepSleep) host::onDeepSleep();
+  abort();
+}
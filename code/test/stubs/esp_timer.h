@@ -0,0 +1,16 @@
+#pragma once
+#include "Arduino.h"
+typedef host::Timer *esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void *);
+typedef int esp_err_t;
+struct esp_timer_create_args_t { esp_timer_cb_t callback; void *arg; int dispatch_method; const char *name; bool skip_unhandled_events; };
+inline esp_err_t esp_timer_create(const esp_timer_create_args_t *a, esp_timer_handle_t *h)
+{
+  host::timer.cb  = a->callback;
+  host::timer.arg = a->arg;
+  *h = &host::timer;
+  return 0;
+}
+inline esp_err_t esp_timer_start_once(esp_timer_handle_t t, uint64_t d) { t->armed = true; t->at = host::us + d; return 0; }
+inline esp_err_t esp_timer_stop(esp_timer_handle_t t)                  { t->armed = false; return 0; }
+inline int64_t   esp_timer_get_time()                                  { return int64_t(host::us); }
@@ -0,0 +1,123 @@
+/* ---------------------------------------------------------------------------
+ *  Host stand-ins for the Arduino / ESP32 APIs the sketch uses
+ *  ------------------------------------------------------------
+ *  Header-only so every test can include the sketch with its own -D flags.
+ *  Time is simulated: micros() reads host::us, delay() and host::advance()
+ *  move it and fire a due esp_timer.  I2C transfers cost simulated time at
+ *  the current Wire clock (9 bits per byte), so bus timing can be measured.
+ * ------------------------------------------------------------------------ */
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <map>
+#include <vector>
+
+namespace host {
+
+inline uint64_t us = 0;                        // simulated clock
+
+/* One pending one-shot timer (the frame timer) */
+struct Timer { void (*cb)(void *) = nullptr; void *arg = nullptr; bool armed = false; uint64_t at = 0; };
+inline Timer timer;
+
+inline void advance(uint64_t dUs)
+{
+  uint64_t end = us + dUs;
+  while (timer.armed && timer.at <= end) {
+    if (timer.at > us) us = timer.at;
+    timer.armed = false;
+    timer.cb(timer.arg);                       // may spend time itself
+  }
+  if (end > us) us = end;
+}
+inline void advanceMs(uint32_t ms) { advance(uint64_t(ms) * 1000); }
+
+/* Serial: output is collected, input is consumed from serialIn */
+inline std::string serialOut, serialIn;
+inline bool        echo = false;
+
+/* Analogue input of the pot */
+inline int analogValue = 0;
+
+/* MPR121 register files, one per address 0x5A…0x5D */
+struct Mpr {
+  bool     present = true;
+  uint8_t  reg[256] = {};
+  uint32_t writes = 0;
+  uint32_t reads  = 0;                         // read transfers addressed to it
+  void setTouched(uint16_t bits) { reg[0] = bits; reg[1] = bits >> 8 & 0x1F; }
+  void setElectrode(uint8_t e, uint16_t filtered, uint16_t baseline)
+  {
+    reg[0x04 + 2 * e] = filtered; reg[0x05 + 2 * e] = filtered >> 8 & 3;
+    reg[0x1E + e]     = baseline >> 2;
+  }
+
+  /* Optional chip model: baselines learn the signal like the MPR121 with
+   * the Adafruit begin() filter settings – ECR CL=10 loads the 5 MSBs of
+   * the first sample, then rising data moves the baseline 1 count per 15
+   * samples and falling data 5 counts per 2.  CL=00 keeps the baseline
+   * registers as written.  Touch status uses thresholds 12 / 6. */
+  bool     model = false;
+  uint16_t signal[13] = {};                    // filtered data, 10-bit
+  uint16_t base[13]   = {};
+  uint8_t  run[13]    = {};
+  uint16_t down       = 0;
+  uint64_t tSync      = 0;
+
+  void reset(uint64_t now)                     // soft reset + begin(): CL=10
+  {
+    for (uint8_t e = 0; e < 13; ++e) { base[e] = signal[e] & 0x3E0; run[e] = 0; }
+    down = 0; tSync = now;
+    sync(now);
+  }
+  void onWrite(uint8_t r, uint8_t v, uint64_t now)
+  {
+    reg[r] = v;
+    writes++;
+    if (!model) return;
+    sync(now);
+    if (r >= 0x1E && r < 0x1E + 13) base[r - 0x1E] = v << 2;
+    if (r == 0x5E && (v & 0xC0) == 0x80) reset(now);
+  }
+  void sync(uint64_t now)
+  {
+    if (!model) return;
+    for (; tSync + 1000 <= now; tSync += 1000)
+      for (uint8_t e = 0; e < 13; ++e) {
+        if (signal[e] > base[e])      { if (++run[e] >= 15) { base[e]++; run[e] = 0; } }
+        else if (signal[e] < base[e]) { if (++run[e] >= 2)  { base[e] = base[e] - signal[e] > 5 ? base[e] - 5 : signal[e]; run[e] = 0; } }
+        else run[e] = 0;
+      }
+    for (uint8_t e = 0; e < 12; ++e) {
+      int d = int(base[e]) - int(signal[e]);
+      if (d > 12)     down |=  1 << e;
+      else if (d < 6) down &= ~(1 << e);
+    }
+    for (uint8_t e = 0; e < 13; ++e) {
+      reg[0x04 + 2 * e] = signal[e]; reg[0x05 + 2 * e] = signal[e] >> 8 & 3;
+      reg[0x1E + e]     = base[e] >> 2;
+    }
+    setTouched(down);
+  }
+};
+inline Mpr mpr[4];
+inline Mpr *mprAt(uint8_t addr) { return addr >= 0x5A && addr < 0x5E ? &mpr[addr - 0x5A] : nullptr; }
+
+inline uint32_t i2cHz     = 100000;
+inline uint32_t i2cBytes  = 0;
+inline void i2cCost(uint32_t bytes)            // start / address / data, 9 bits each
+{
+  i2cBytes += bytes;
+  advance(uint64_t(bytes) * 9 * 1000000 / i2cHz);
+}
+
+/* ESP32 */
+inline int  wakeCause = 0;                     // esp_sleep_wakeup_cause_t
+inline void (*onDeepSleep)() = nullptr;        // must not return
+inline std::map<std::string, std::vector<uint8_t>> nvs;
+
+}  // namespace host
@@ -0,0 +1,160 @@
+/* ---------------------------------------------------------------------------
+ *  Lamp arbiter: who owns each group, and what it paints
+ *  -----------------------------------------------------
+ *  Each row sets a state word and names the owner every group must end up
+ *  with (CLAIMS resolved by Feature priority).  After compose() the owner
+ *  is read back from the committed frame's keys and every pixel of the
+ *  Mock strips is checked against what that owner paints at that frame.
+ *  Then hazard preempts a running turn signal, which must come back in its
+ *  old phase, and show mode takes every group and hands them back.
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include "check.h"
+
+constexpr Feature NO = FT_NONE;
+
+struct Row {
+  const char *name;
+  uint32_t    st;
+  Feature     owner[NUM_GROUPS];               // GYRO, TURN_L, TURN_R, HEAD, TAIL
+};
+const Row ROWS[] = {
+  { "dark",               0,                              { NO, NO, NO, NO, NO } },
+  { "low beam",           ST_LOW_BEAM | ST_TAIL,          { NO, NO, NO, FT_LOW_BEAM, FT_TAIL } },
+  { "head over low beam", ST_LOW_BEAM | ST_HEAD,          { NO, NO, NO, FT_HEAD, NO } },
+  { "turn right",         ST_TURN_R | ST_HEAD,            { NO, NO, FT_TURN_R, FT_HEAD, NO } },
+  { "hazard over turn",   ST_TURN_L | ST_HAZARD,          { NO, FT_HAZARD, FT_HAZARD, NO, NO } },
+  { "gyro",               ST_GYRO | ST_TAIL,              { FT_GYRO, NO, NO, NO, FT_TAIL } },
+  { "preview over lamps", ST_CFG_MAIN_BR | ST_HEAD | ST_LOW_BEAM | ST_TURN_R,
+                                                          { NO, NO, FT_TURN_R, FT_PREVIEW, FT_PREVIEW } },
+  { "preview over hazard", ST_CFG_TURN_BR | ST_HAZARD | ST_GYRO,
+                                                          { FT_GYRO, FT_PREVIEW, FT_PREVIEW, NO, NO } },
+  { "colour preview",     ST_CFG_TAIL_COL | ST_TAIL | ST_HEAD,
+                                                          { NO, NO, NO, FT_HEAD, FT_PREVIEW } },
+  { "show over all",      ST_SHOW | ST_HAZARD | ST_HEAD | ST_CFG_GYRO_BR | ST_GYRO,
+                                                          { FT_SHOW, FT_SHOW, FT_SHOW, FT_SHOW, FT_SHOW } },
+};
+
+static uint8_t brOf(StripId s)
+{
+  return s == STRIP_GYRO ? preset().brGyroInit : s == STRIP_TURN ? preset().brTurnInit : preset().brMainInit;
+}
+
+/* The strip's wire bytes for pixel i equal colour c */
+static bool pixelIs(StripId s, uint8_t i, uint32_t c)
+{
+  PixelBuffer ref(strips[s]->numPixels(), WB_MAIN);   // all white balances are unity
+  ref.setBrightness(brOf(s));
+  ref.setPixelColor(i, c);
+  return !memcmp(strips[s]->getPixels() + 3 * i, ref.getPixels() + 3 * i, 3);
+}
+
+/* Every pixel of group g as `owner` paints it at animation frame `frame` */
+static bool groupIs(LampGroup g, Feature owner, uint8_t frame)
+{
+  const LampGroupMap &m = GROUPS[g];
+  const Presets      &p = preset();
+  bool                ok = true;
+  for (uint8_t k = 0; k < m.count; ++k) {
+    uint8_t  i = m.px[k];
+    uint32_t c = 0;
+    switch (owner) {
+      case FT_LOW_BEAM: c = LOW_BEAM_PX & _BV(i) ? p.colHeadInit : 0; break;
+      case FT_HEAD:     c = p.colHeadInit;                            break;
+      case FT_TAIL:     c = p.colTailInit;                            break;
+      case FT_TURN_R:
+      case FT_TURN_L:
+      case FT_HAZARD:   c = (SEQ_TURN ? k < frame : frame) ? p.colTurnInit : 0; break;
+      case FT_PREVIEW:
+        c = g == GRP_HEAD ? p.colHeadInit
+          : g == GRP_TAIL ? (stateTest(ST_CFG_TAIL_COL) ? scene().cfgColour : p.colTailInit)
+          :                 p.colTurnInit;
+        break;
+      case FT_GYRO:                            // either colour, by phase
+        ok &= pixelIs(m.strip, i, p.colGyroA) || pixelIs(m.strip, i, p.colGyroB);
+        continue;
+      default:          c = 0;                                        break;
+    }
+    ok &= pixelIs(m.strip, i, c);
+  }
+  return ok;
+}
+
+static Feature ownerOf(LampGroup g) { return Feature(comp.img.key[g] >> 4); }
+static uint8_t frameOf(LampGroup g) { return comp.img.key[g] & 0x0F; }
+
+static void setState(uint32_t st)
+{
+  stateUpdate(~0u, 0, st);
+  for (uint8_t s = 0; s < NUM_STRIPS; ++s) composeInvalidate(StripId(s));
+  compose(micros());
+}
+
+int main()
+{
+  setup();
+  host::advanceMs(100);
+
+  /* The table: owners from the claims, pixels from the owners */
+  for (const Row &r : ROWS) {
+    turnSync();
+    setState(r.st);
+    for (uint8_t g = 0; g < NUM_GROUPS; ++g) {
+      Feature got = ownerOf(LampGroup(g));
+      if (got != r.owner[g]) {
+        fprintf(stderr, "%s: group %u owned by %u, want %u\n", r.name, g, got, r.owner[g]);
+        checkFailures++;
+      } else if (got != FT_SHOW && !groupIs(LampGroup(g), got, frameOf(LampGroup(g)))) {
+        fprintf(stderr, "%s: group %u pixels are not %u's\n", r.name, g, got);
+        checkFailures++;
+      }
+    }
+    if (r.st & ST_SHOW) CHECK_EQ(comp.img.groups, 0);   // the scripts paint, compose does not
+  }
+
+  /* Hazard preempts a turn signal; the turn resumes on its own origin.
+     Resume 3½ half-periods in, when the turn is in a dark half. */
+  setState(0);
+  host::advanceMs(7);
+  turnSync();
+  setState(ST_TURN_R);
+  unsigned long org = scene().tOrgTurn;
+  CHECK_EQ(ownerOf(GRP_TURN_R), FT_TURN_R);
+  host::advanceMs(HP_TURN / 2);
+  turnSync();                                  // hazard pressed: origin kept
+  stateSet(ST_HAZARD);
+  compose(micros());
+  CHECK_EQ(ownerOf(GRP_TURN_R), FT_HAZARD);
+  CHECK_EQ(ownerOf(GRP_TURN_L), FT_HAZARD);
+  CHECK_EQ(scene().tOrgTurn, org);
+  while (long(tempoNow() - org) < 3 * HP_TURN + HP_TURN / 2) { host::advanceMs(1); compose(micros()); }
+  stateClear(ST_HAZARD);
+  compose(micros());
+  unsigned long t = tempoNow() - org;
+  CHECK_EQ(ownerOf(GRP_TURN_R), FT_TURN_R);
+  CHECK_EQ(ownerOf(GRP_TURN_L), NO);
+  CHECK_EQ(frameOf(GRP_TURN_R), (t / HP_TURN & 1) == 0);   // dark: the old phase
+  CHECK_EQ(frameOf(GRP_TURN_R), 0);
+  CHECK(groupIs(GRP_TURN_R, FT_TURN_R, 0));
+  CHECK(groupIs(GRP_TURN_L, NO, 0));
+  while (long(tempoNow() - org) < 4 * HP_TURN + 1) { host::advanceMs(1); compose(micros()); }
+  CHECK(frameOf(GRP_TURN_R) != 0);             // lit again on the old grid
+  CHECK(groupIs(GRP_TURN_R, FT_TURN_R, frameOf(GRP_TURN_R)));
+
+  /* Show mode takes everything, then gives every group back */
+  setState(ST_HEAD | ST_GYRO);
+  effectToggle(ST_SHOW);
+  for (uint8_t k = 0; k < 50; ++k) { scriptsRun(tempoNow()); compose(micros()); host::advanceMs(1); }
+  for (uint8_t g = 0; g < NUM_GROUPS; ++g) CHECK_EQ(ownerOf(LampGroup(g)), FT_SHOW);
+  CHECK(stateTest(ST_HEAD | ST_GYRO));         // underneath, untouched
+  effectToggle(ST_SHOW);
+  compose(micros());
+  CHECK_EQ(ownerOf(GRP_HEAD), FT_HEAD);
+  CHECK_EQ(ownerOf(GRP_GYRO), FT_GYRO);
+  CHECK(groupIs(GRP_HEAD, FT_HEAD, 1));
+  CHECK(groupIs(GRP_GYRO, FT_GYRO, frameOf(GRP_GYRO)));
+
+  printf("arbiter: %zu claim rows, hazard over turn in phase, show over all\n",
+         sizeof ROWS / sizeof ROWS[0]);
+  return checkDone("test_arbiter");
+}
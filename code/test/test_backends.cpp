@@ -0,0 +1,141 @@
+/* ---------------------------------------------------------------------------
+ *  LED backends: the bytes on the wire for known pixels
+ *  ----------------------------------------------------
+ *  Built as an ESP32 with the strips on the recorder, SPI and RMT outputs,
+ *  so every backend but NeoPixel is compiled in (the Mock one always is).
+ *  Each gets its own eight-pixel strip and three frames of known colours;
+ *  what it emitted is decoded – the recorder's file, the RMT items, the
+ *  SPI symbols – and must be those pixels in GRB order, once per frame.
+ *  Gamma is off and the white balance unity, so the encode is the identity.
+ * ------------------------------------------------------------------------ */
+#define LED_RECORD_PATH "build/test_backends.rec"
+#include "../full_implementation.cpp"
+#include "check.h"
+
+static_assert(!LED_GAMMA, "the expected bytes assume an identity encode");
+constexpr uint16_t N      = 8;
+constexpr uint8_t  FRAMES = 3;
+constexpr WhiteBalance WB_UNITY = { 255, 255, 255 };
+
+static uint32_t colour(uint8_t frame, uint8_t i)
+{
+  return PixelBuffer::Color(0x10 + 16 * frame + i, 0x80 + i, 0xF0 - 8 * frame - i);
+}
+
+/* The GRB bytes frame `frame` must put on the wire */
+static void expected(uint8_t frame, uint8_t *w)
+{
+  for (uint8_t i = 0; i < N; ++i) {
+    uint32_t c = colour(frame, i);
+    w[3 * i]     = c >> 8;
+    w[3 * i + 1] = c >> 16;
+    w[3 * i + 2] = c;
+  }
+}
+
+template<typename Backend, typename Check>
+static void drive(LedStrip<Backend> &px, const char *name, Check afterShow)
+{
+  px.begin();
+  for (uint8_t f = 0; f < FRAMES; ++f) {
+    for (uint8_t i = 0; i < N; ++i) px.setPixelColor(i, colour(f, i));
+    host::advance(5000);                       // the backends wait out the latch
+    px.show();
+    uint8_t want[3 * N];
+    expected(f, want);
+    if (!afterShow(px.backend(), f, want)) {
+      fprintf(stderr, "%s: frame %u differs\n", name, f);
+      checkFailures++;
+    }
+  }
+}
+
+/* RMT items → bytes, checking every item is exactly BIT0 or BIT1 */
+static bool rmtDecode(const std::vector<rmt_item32_t> &items, std::vector<uint8_t> &out)
+{
+  if (items.size() % 8) return false;
+  out.assign(items.size() / 8, 0);
+  for (size_t k = 0; k < items.size(); ++k) {
+    uint32_t v = items[k].val;
+    if (v != RmtBackend::BIT0.val && v != RmtBackend::BIT1.val) return false;
+    out[k / 8] = out[k / 8] << 1 | (v == RmtBackend::BIT1.val);
+  }
+  return true;
+}
+
+/* SPI MOSI → bytes: a lead-in zero byte, then per LED bit a symbol of Bits
+   SPI bits that is 1 0…0 (a 0) or 1 1 0…0 (a 1) */
+template<uint8_t Bits>
+static bool spiDecode(const std::vector<uint8_t> &mosi, std::vector<uint8_t> &out)
+{
+  if (mosi.empty() || mosi[0] || (mosi.size() - 1) % Bits) return false;
+  size_t nbits = (mosi.size() - 1) * 8;
+  auto   bit   = [&](size_t k) { return mosi[1 + k / 8] >> (7 - k % 8) & 1; };
+  out.assign(nbits / Bits / 8, 0);
+  for (size_t s = 0; s < nbits / Bits; ++s) {
+    uint8_t sym = 0;
+    for (uint8_t k = 0; k < Bits; ++k) sym = sym << 1 | bit(s * Bits + k);
+    uint8_t zero = 1 << (Bits - 1), one = 3 << (Bits - 2);
+    if (sym != zero && sym != one) return false;
+    out[s / 8] = out[s / 8] << 1 | (sym == one);
+  }
+  return true;
+}
+
+int main()
+{
+  /* Mock: the last frame and a frame count */
+  static LedStrip<MockBackend> mock(N, 1, WB_UNITY);
+  drive(mock, "mock", [](MockBackend &b, uint8_t f, const uint8_t *want) {
+    return b.bytes == 3 * N && b.frames == f + 1u && !memcmp(b.wire, want, 3 * N);
+  });
+
+  /* Recorder: one "micros pin hex…" line per frame */
+  static LedStrip<RecorderBackend> rec(N, 21, WB_UNITY);
+  drive(rec, "recorder", [](RecorderBackend &, uint8_t, const uint8_t *) { return true; });
+  CHECK(RecorderBackend::file != nullptr);
+  if (RecorderBackend::file) fflush(RecorderBackend::file);
+  FILE *in = fopen(LED_RECORD_PATH, "r");
+  CHECK(in != nullptr);
+  uint8_t lines = 0;
+  for (char line[1024]; in && fgets(line, sizeof line, in); ++lines) {
+    unsigned long us;
+    unsigned      pin;
+    int           used;
+    CHECK(sscanf(line, "%lu %u%n", &us, &pin, &used) == 2);
+    CHECK_EQ(pin, 21);
+    uint8_t want[3 * N], got[3 * N];
+    expected(lines, want);
+    const char *p = line + used;
+    uint16_t    n = 0;
+    for (unsigned v; n < 3 * N && sscanf(p, " %2x%n", &v, &used) == 1; p += used) got[n++] = v;
+    CHECK_EQ(n, 3 * N);
+    CHECK(strcmp(p, "\n") == 0);
+    CHECK(!memcmp(got, want, 3 * N));
+  }
+  if (in) fclose(in);
+  CHECK_EQ(lines, FRAMES);
+
+  /* RMT: the translator's bit items on the strip's channel */
+  static LedStrip<RmtBackend> rmt(N, 22, WB_UNITY);
+  drive(rmt, "rmt", [](RmtBackend &b, uint8_t f, const uint8_t *want) {
+    std::vector<uint8_t> got;
+    const host::RmtChannel &c = host::rmt[b.ch];
+    return c.writes == f + 1u && rmtDecode(c.items, got) &&
+           got.size() == 3 * N && !memcmp(got.data(), want, 3 * N);
+  });
+
+  /* SPI: the MOSI symbols of the DMA transaction */
+  using Spi = SpiBackend<SPI_LED_BITS, SPI_LED_HZ>;
+  static LedStrip<Spi> spi(N, 23, WB_UNITY);
+  drive(spi, "spi", [](Spi &, uint8_t f, const uint8_t *want) {
+    std::vector<uint8_t> got;
+    const host::SpiHost &h = host::spi[SPI2_HOST];
+    return h.writes == f + 1u && h.hz == SPI_LED_HZ && spiDecode<SPI_LED_BITS>(h.mosi, got) &&
+           got.size() == 3 * N && !memcmp(got.data(), want, 3 * N);
+  });
+
+  printf("backends: mock, recorder, rmt, spi: %u frames of %u pixels each, GRB as set\n",
+         FRAMES, N);
+  return checkDone("test_backends");
+}
@@ -0,0 +1,170 @@
+/* ---------------------------------------------------------------------------
+ *  Boot → first valid touch, with and without the calibration cache
+ *  ----------------------------------------------------------------
+ *  The stub MPR121 runs its baseline model: after begin() the baselines
+ *  start from the 5 MSBs of the data and creep onto it, so touches are not
+ *  trustworthy until they are within CAL_TOLERANCE ("touch-ready").  Each
+ *  boot runs in a forked child so the sketch starts from a clean image; NVS
+ *  is carried from one boot to the next.  A last boot starts without the
+ *  sensor and has it fitted later.
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include "check.h"
+#include <unistd.h>
+#include <sys/wait.h>
+
+struct BootResult {
+  long     readyMs;                            // -1 = never
+  uint32_t i2cHz;
+  bool     cached;                             // NVS holds a calibration afterwards
+  uint8_t  cal[sizeof(CalImage)];
+};
+
+static void run(uint32_t ms)
+{
+  for (uint32_t t = 0; t < ms; ++t) { loop(); host::advanceMs(1); }
+}
+
+static BootResult boot(const BootResult *nvs, int16_t shift)
+{
+  int fd[2];
+  if (pipe(fd)) { perror("pipe"); exit(1); }
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fd[0]);
+    if (nvs && nvs->cached) host::nvs["mpr121/cal0"].assign(nvs->cal, nvs->cal + sizeof nvs->cal);
+    host::Mpr &m = host::mpr[0];
+    m.model = true;
+    for (uint8_t e = 0; e < NUM_CHANNELS; ++e) m.signal[e] = 700 + 3 * e + shift;
+
+    BootResult r = {};
+    r.readyMs = -1;
+    setup();
+    while (host::us < 4000000) {               // past CAL_SETTLE_MS, so learning caches
+      run(1);
+      size_t at = host::serialOut.find("touch-ready at ");
+      if (r.readyMs < 0 && at != std::string::npos) {
+        r.readyMs = atol(host::serialOut.c_str() + at + 15);
+        r.i2cHz   = host::i2cHz;
+      }
+    }
+    auto it = host::nvs.find("mpr121/cal0");
+    r.cached = it != host::nvs.end() && it->second.size() == sizeof r.cal;
+    if (r.cached) memcpy(r.cal, it->second.data(), sizeof r.cal);
+    ssize_t n = write(fd[1], &r, sizeof r);
+    _exit(n == sizeof r ? 0 : 1);
+  }
+  close(fd[1]);
+  BootResult r = {};
+  if (read(fd[0], &r, sizeof r) != sizeof r) CHECK(!"child sent no result");
+  close(fd[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  return r;
+}
+
+/* Sensor 0 missing at boot, fitted at PRESENT_MS: lights work without it,
+   its touches are ignored, and it comes up on the first retry after it is
+   there.  Retries follow SENSOR_RETRY_MS doubling to SENSOR_RETRY_MAX; each
+   attempt can slip by a poll period plus a failed begin() on the bus. */
+constexpr uint32_t PRESENT_MS = 500;
+constexpr uint32_t SLIP_MS    = TOUCH_POLL_US / 1000 + 1 + 5;
+
+struct AbsentResult {
+  uint64_t firstFrameUs;                       // setup() to its first frame
+  long     firstFramePrinted;                  // ms, as reported on Serial
+  bool     lit, inert;
+  uint8_t  notFound;                           // "not found" reports
+  long     upMs;                               // -1 = never
+};
+
+static AbsentResult absentBoot()
+{
+  int fd[2];
+  if (pipe(fd)) { perror("pipe"); exit(1); }
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fd[0]);
+    AbsentResult r = {};
+    r.upMs = -1;
+    host::mpr[0].present = false;
+    setup();
+    r.firstFrameUs = host::us;
+    size_t at = host::serialOut.find("Boot → first frame ");
+    r.firstFramePrinted = at == std::string::npos ? -1 : atol(host::serialOut.c_str() + at + strlen("Boot → first frame "));
+
+    stateSet(ST_HEAD);                         // lights without a sensor
+    run(20);
+    const LampGroupMap &m = GROUPS[GRP_HEAD];
+    r.lit = pxMain.getPixels()[3 * m.px[0]] != 0;
+
+    host::mpr[0].setTouched(uint16_t(TK_HEAD));   // a finger on a missing sensor
+    bool quiet = true;
+    while (host::us < 300000) { run(1); quiet &= touchState() == 0; }
+    host::mpr[0].setTouched(0);
+    r.inert = quiet && stateTest(ST_HEAD) && gSensorsUp.load() == 0;
+
+    while (host::us < uint64_t(PRESENT_MS) * 1000) run(1);
+    host::mpr[0].present = true;
+    while (host::us < 20000000 && gSensorsUp.load() != SENSORS_ALL) run(1);
+    at = host::serialOut.find("MPR121 0x5A up");
+    if (at != std::string::npos) {
+      size_t ms = host::serialOut.find(" at ", at);
+      r.upMs = atol(host::serialOut.c_str() + ms + 4);
+    }
+    for (at = 0; (at = host::serialOut.find("not found", at)) != std::string::npos; ++at) r.notFound++;
+    ssize_t n = write(fd[1], &r, sizeof r);
+    _exit(n == sizeof r ? 0 : 1);
+  }
+  close(fd[1]);
+  AbsentResult r = {};
+  if (read(fd[0], &r, sizeof r) != sizeof r) CHECK(!"child sent no result");
+  close(fd[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  return r;
+}
+
+int main()
+{
+  BootResult cold = boot(nullptr, 0);          // before: learn from scratch
+  CHECK(cold.readyMs >= 0);
+  CHECK(cold.cached);
+  CHECK_EQ(cold.i2cHz, TOUCH_I2C_HZ);
+
+  BootResult warm = boot(&cold, 0);            // after: cached calibration
+  CHECK(warm.readyMs >= 0);
+  CHECK(warm.readyMs < cold.readyMs);
+  CHECK_EQ(warm.i2cHz, TOUCH_I2C_HZ);
+
+  BootResult moved = boot(&cold, 40);          // surroundings changed: relearn
+  CHECK(moved.readyMs >= 0);
+  CHECK_EQ(moved.i2cHz, TOUCH_I2C_HZ);         // not left at begin()'s 100 kHz
+
+  printf("boot -> first valid touch: learning %ld ms, cached %ld ms, cache rejected %ld ms\n",
+         cold.readyMs, warm.readyMs, moved.readyMs);
+
+  AbsentResult ab = absentBoot();
+  uint64_t wire = 0;                           // the first frame sends every strip
+  for (PixelBuffer *px : strips) wire += px->numPixels() * 24 * (LED_T0H_NS + LED_T0L_NS) / 1000;
+  CHECK(ab.firstFrameUs >= wire);
+  CHECK(ab.firstFrameUs <= uint64_t(FIRST_FRAME_MS) * 1000);
+  CHECK_EQ(ab.firstFramePrinted, long(ab.firstFrameUs / 1000));
+  CHECK(ab.lit);
+  CHECK(ab.inert);
+  CHECK_EQ(ab.notFound, 1);                    // reported once, retried quietly
+
+  uint32_t attempt = 0, wait = SENSOR_RETRY_MS, tries = 0;
+  while (attempt < PRESENT_MS) {               // the first retry after it is fitted
+    attempt += wait;
+    wait     = wait >= SENSOR_RETRY_MAX / 2 ? SENSOR_RETRY_MAX : 2 * wait;
+    tries++;
+  }
+  CHECK(ab.upMs >= long(attempt));             // the back-off is kept …
+  CHECK(ab.upMs <= long(attempt + tries * SLIP_MS));   // … and not overslept
+  printf("boot without sensor: first frame %llu us; fitted at %u ms, up at %ld ms (retry due %u ms)\n",
+         (unsigned long long)ab.firstFrameUs, PRESENT_MS, ab.upMs, attempt);
+  return checkDone("test_boot");
+}
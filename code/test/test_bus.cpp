@@ -0,0 +1,32 @@
+/* ---------------------------------------------------------------------------
+ *  Touch bus: the burst time measured per sample reaches the 's' report
+ *  ------------------------------------------------------------------
+ *  The stub bus charges 9 bits per byte at the Wire clock, so one 43-byte
+ *  burst (46 bytes with addressing) is 1035 us at 400 kHz, 4140 us at 100.
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include "check.h"
+
+static void run(uint32_t ms)
+{
+  for (uint32_t t = 0; t < ms; ++t) { loop(); host::advanceMs(1); }
+}
+
+int main()
+{
+  setup();
+  run(200);
+
+  host::serialOut.clear();
+  host::serialIn = "s";
+  run(50);
+
+  size_t at = host::serialOut.find("Bus 0: ");
+  CHECK(at != std::string::npos);
+  if (at != std::string::npos) {
+    long us = atol(host::serialOut.c_str() + at + 7);
+    printf("bus: reported %ld us per burst at %u Hz\n", us, host::i2cHz);
+    CHECK_EQ(us, 46L * 9 * 1000000 / host::i2cHz);
+  }
+  return checkDone("test_bus");
+}
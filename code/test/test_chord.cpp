@@ -0,0 +1,87 @@
+/* ---------------------------------------------------------------------------
+ *  chordResolve(): raw electrode level over time in, press events out
+ *  ------------------------------------------------------------------
+ *  Two-finger chords are pressed with the inter-finger skew drawn from
+ *  log-normal distributions (tight / typical / sloppy hands) and released
+ *  with their own skew.  Every press must give exactly one chord when the
+ *  second finger lands within CHORD_SKEW_MS (inclusive) and two singles otherwise,
+ *  and nothing more while the fingers lift.
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include "check.h"
+#include <random>
+
+static std::vector<TouchMask> events;
+
+/* One millisecond per call, as loop() runs it */
+static void feed(TouchMask raw, unsigned long &t, uint32_t ms)
+{
+  for (uint32_t i = 0; i < ms; ++i, ++t)
+    if (TouchMask ev = chordResolve(raw, t)) events.push_back(ev);
+}
+
+/* Press a then b `skewMs` later, hold, lift a then b `liftMs` apart */
+static void chordPress(TouchMask a, TouchMask b, uint32_t skewMs, uint32_t liftMs, unsigned long &t)
+{
+  events.clear();
+  feed(a,     t, skewMs);
+  feed(a | b, t, 150);
+  feed(b,     t, liftMs);
+  feed(0,     t, 300);
+}
+
+struct Hand { const char *name; double medianMs, sigma; };
+
+int main()
+{
+  unsigned long t = 1000;
+
+  /* A lone key waits out the window, then fires once */
+  chord = ChordResolver();
+  events.clear();
+  feed(TK_HEAD, t, 400);
+  feed(0, t, 100);
+  CHECK_EQ(events.size(), 1);
+  CHECK_EQ(events[0], TK_HEAD);
+
+  /* Two keys that form no chord come out as singles at once, lowest first */
+  chord = ChordResolver();
+  events.clear();
+  feed(TK_GYRO | TK_TURN_R, t, 3);
+  CHECK_EQ(events.size(), 2);
+  if (events.size() == 2) { CHECK_EQ(events[0], TK_GYRO); CHECK_EQ(events[1], TK_TURN_R); }
+
+  /* Lifting the first finger before the partner lands gives a single */
+  chord = ChordResolver();
+  events.clear();
+  feed(TK_CTRL, t, 30);
+  feed(0, t, 200);
+  CHECK_EQ(events.size(), 1);
+  if (events.size() == 1) CHECK_EQ(events[0], TK_CTRL);
+
+  /* Skew distributions over every chord, in both finger orders */
+  const Hand hands[] = { { "tight", 12, 0.5 }, { "typical", 25, 0.6 }, { "sloppy", 45, 0.7 } };
+  std::mt19937 rng(58);
+  for (const Hand &h : hands) {
+    std::lognormal_distribution<double> skew(log(h.medianMs), h.sigma);
+    uint32_t trials = 0, chords = 0, wrong = 0;
+    for (int i = 0; i < 3000; ++i) {
+      TouchMask c  = CHORDS[i % (sizeof CHORDS / sizeof CHORDS[0])];
+      TouchMask lo = c & (~c + 1), hi = c & ~lo;
+      TouchMask a  = i & 1 ? lo : hi, b = c & ~a;
+      uint32_t  s  = uint32_t(skew(rng)) + 1;
+      uint32_t  l  = uint32_t(skew(rng)) + 1;
+      chord = ChordResolver();
+      chordPress(a, b, s, l, t);
+      trials++;
+      bool ok = s <= CHORD_SKEW_MS ? events.size() == 1 && events[0] == c
+                                  : events.size() == 2 && events[0] == a && events[1] == b;
+      wrong  += !ok;
+      chords += events.size() == 1 && events[0] == c;
+    }
+    CHECK_EQ(wrong, 0);
+    printf("chord: %-7s hand (median %2.0f ms): %5.1f %% of %u presses recognised as chords\n",
+           h.name, h.medianMs, 100.0 * chords / trials, trials);
+  }
+  return checkDone("test_chord");
+}
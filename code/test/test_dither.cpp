@@ -0,0 +1,72 @@
+/* ---------------------------------------------------------------------------
+ *  LED_DITHER: temporal error of the 16-bit → 8-bit output quantiser
+ *  -----------------------------------------------------------------
+ *  For every colour level at low brightness the wire bytes of successive
+ *  frames must only be the two neighbouring 8-bit steps, and their running
+ *  mean must converge on the 16-bit target: over any 16 frames (40 ms at
+ *  the 400 Hz refresh) within 1/16 step, over 256 frames exact.  Plain
+ *  truncation is reported for comparison.  The white balance is neutral
+ *  and gamma comes before the quantiser, so the wire bytes are its output;
+ *  test_dither_gamma runs the same with LED_GAMMA, where at full brightness
+ *  every code but the lowest must keep a level of its own.
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include "check.h"
+#include <math.h>
+
+static_assert(LED_DITHER, "build with -DLED_DITHER=1");
+
+int main()
+{
+  constexpr uint16_t FRAMES = 256, WIN = 16;
+  double   worstWin = 0, worstTrunc = 0, sumWin = 0;
+  uint32_t cases = 0;
+
+  for (uint8_t br = 1; br <= 40; ++br) {
+    stripBrightness(STRIP_MAIN, br);
+    for (uint16_t v = 0; v < 256; ++v) {
+      outStage[STRIP_MAIN] = OutputStrip();
+      stripBrightness(STRIP_MAIN, br);
+      stripSet(STRIP_MAIN, 0, PixelBuffer::Color(v, 0, 0));
+      uint16_t target = GAMMA16.v[v] * (br + 1) >> 8;   // 8.8 fixed point
+      double   exact  = target / 256.0;
+
+      uint8_t  out[FRAMES];
+      uint32_t total = 0;
+      for (uint16_t f = 0; f < FRAMES; ++f) {
+        stripShow(STRIP_MAIN);
+        out[f] = pxMain.backend().wire[1];     // GRB: red is the second byte
+        total += out[f];
+        CHECK(out[f] == target >> 8 || out[f] == (target >> 8) + 1);
+      }
+      CHECK_EQ(total, target);                 // 256 frames: exact on average
+
+      for (uint16_t f = 0; f + WIN <= FRAMES; ++f) {
+        uint32_t s = 0;
+        for (uint16_t k = 0; k < WIN; ++k) s += out[f + k];
+        double e = fabs(double(s) / WIN - exact);
+        if (e > worstWin) worstWin = e;
+        sumWin += e;
+        cases++;
+      }
+      double t = exact - (target >> 8);
+      if (t > worstTrunc) worstTrunc = t;
+    }
+  }
+  CHECK(worstWin <= 1.0 / WIN + 1e-9);
+
+  /* Full brightness: distinct levels the 16-bit path keeps against the
+     8-bit table it replaces */
+  uint16_t levels = 1, levels8 = 1;
+  for (uint16_t v = 1; v < 256; ++v) {
+    levels  += GAMMA16.v[v] != GAMMA16.v[v - 1];
+    levels8 += GAMMA8.v[v] != GAMMA8.v[v - 1];
+  }
+  CHECK(levels >= 255);
+  if (!LED_GAMMA) CHECK_EQ(levels8, 256);
+
+  printf("dither%s: |mean error| over %u frames: worst %.4f, average %.4f steps; "
+         "truncation worst %.4f; %u levels at full brightness (8-bit table %u)\n",
+         LED_GAMMA ? " (gamma)" : "", WIN, worstWin, sumWin / cases, worstTrunc, levels, levels8);
+  return checkDone(LED_GAMMA ? "test_dither_gamma" : "test_dither");
+}
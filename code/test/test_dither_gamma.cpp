@@ -0,0 +1,2 @@
+/* test_dither.cpp with LED_GAMMA: gamma before the dither */
+#include "test_dither.cpp"
@@ -0,0 +1,45 @@
+/* ---------------------------------------------------------------------------
+ *  Frame edges: commit lateness against the tempo clock's own edges
+ *  ----------------------------------------------------------------
+ *  Runs the sketch as an ESP32 so the esp_timer drives compose().  The stub
+ *  timer fires exactly when armed, so what is left is the arming error: a
+ *  commit must never come before the edge, and at most the microsecond the
+ *  deadline is rounded up to after it.
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include "check.h"
+
+static void run(uint32_t ms)
+{
+  for (uint32_t t = 0; t < ms; ++t) { loop(); host::advanceMs(1); }
+}
+
+int main()
+{
+  setup();
+  run(100);
+
+  static const uint16_t BEATS[] = { 1500, 500, 461, 333, 250 };   // 40 … 240 BPM
+  for (uint16_t beatMs : BEATS) {
+    for (CommitJitter &j : jitter) j = CommitJitter();
+    tempoSet(beatMs);
+    turnSync();
+    stateSet(ST_HAZARD);
+    run(10000);
+    stateClear(ST_HAZARD);
+    run(100);
+
+    uint32_t n = 0;
+    long     lo = 0x7FFFFFFF, hi = -0x7FFFFFFF;
+    for (const CommitJitter &j : jitter) {
+      n += j.n;
+      if (j.n && j.minUs < lo) lo = j.minUs;
+      if (j.n && j.maxUs > hi) hi = j.maxUs;
+    }
+    printf("frames: beat %4u ms: %3u edges, late %ld … %ld us\n", beatMs, n, lo, hi);
+    CHECK(n > 10);
+    CHECK(lo >= 0);                            // never before the edge
+    CHECK(hi <= 1);                            // rounded up to the µs, no more
+  }
+  return checkDone("test_frames");
+}
@@ -0,0 +1,89 @@
+/* ---------------------------------------------------------------------------
+ *  Long-press brightness: steps, the stored preset and the lamp state
+ *  ------------------------------------------------------------------
+ *  The head electrode is held through the real loop().  The level must
+ *  follow the repeat table (REPEAT_MS / REPEAT_AFTER after LONG_PRESS_MS),
+ *  be on the strip after every step, be stored as brMainInit on release –
+ *  also when the release falls between two steps – and the head lamp must
+ *  be on afterwards whether the press switched it on or off.
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include "check.h"
+
+/* loop() with a ms between passes, for `ms` of the stub clock (the touch
+   bursts take bus time on top) */
+static void run(uint32_t ms)
+{
+  for (uint64_t end = host::us + uint64_t(ms) * 1000; host::us < end; host::advanceMs(1)) loop();
+}
+
+/* Steps a hold of `ms` gives: the first at LONG_PRESS_MS, then the table */
+static uint16_t stepsIn(uint32_t ms)
+{
+  uint16_t n = 0;
+  for (uint32_t t = LONG_PRESS_MS; t <= ms; ++n)
+    t += n + 1 < REPEAT_AFTER[0] ? REPEAT_MS[0] : n + 1 < REPEAT_AFTER[1] ? REPEAT_MS[1] : REPEAT_MS[2];
+  return n;
+}
+
+/* Head pixels as the strip would encode brMainInit = `br` */
+static bool headAt(uint8_t br)
+{
+  const LampGroupMap &m = GROUPS[GRP_HEAD];
+  PixelBuffer ref(NUM_HEADTAIL_PIXELS, WB_MAIN);
+  ref.setBrightness(br);
+  ref.setPixelColor(m.px[0], preset().colHeadInit);
+  return !memcmp(pxMain.getPixels() + 3 * m.px[0], ref.getPixels() + 3 * m.px[0], 3);
+}
+
+/* Hold the head electrode `ms`, release, let the taps time out */
+static void hold(uint32_t ms)
+{
+  host::mpr[0].setTouched(uint16_t(TK_HEAD));
+  run(ms);
+  host::mpr[0].setTouched(0);
+  run(1500);
+}
+
+int main()
+{
+  setup();
+  run(100);
+  CHECK_EQ(preset().brMainInit, 100);
+  CHECK(!stateTest(ST_HEAD));
+
+  /* 2 s from dark: the press switches the lamp on, the hold brightens it */
+  uint16_t n = stepsIn(2000);
+  host::mpr[0].setTouched(uint16_t(TK_HEAD));
+  run(2000);
+  CHECK(stateTest(ST_HEAD));
+  uint8_t held = brStage.level[STRIP_MAIN];
+  CHECK(held >= 100 + n - 1 && held <= 100 + n);  // the pass that lands on an edge
+  CHECK_EQ(preset().brMainInit, 100);          // stored on release only
+  CHECK(headAt(held));                         // each step reaches the strip
+  host::mpr[0].setTouched(0);
+  run(1500);
+  printf("longpress: 2 s hold, %u steps expected: brMainInit 100 -> %u\n", n, preset().brMainInit);
+  CHECK_EQ(preset().brMainInit, held);
+  CHECK(stateTest(ST_HEAD));
+  CHECK(headAt(held));
+
+  /* Lamp on: the press switches it off, the long press puts it back on;
+     this hold runs the other way */
+  hold(1000);
+  CHECK(stateTest(ST_HEAD));
+  uint8_t down = preset().brMainInit;
+  CHECK(down < held);
+  CHECK_EQ(held - down, stepsIn(1000));
+
+  /* Release between two steps: the last step stands, nothing half-done */
+  uint32_t mid = LONG_PRESS_MS + REPEAT_MS[0] + REPEAT_MS[0] / 2;   // 2 steps + ½ period
+  hold(mid);
+  CHECK(stateTest(ST_HEAD));
+  CHECK_EQ(preset().brMainInit, down + 2);
+  CHECK_EQ(brStage.level[STRIP_MAIN], down + 2);
+  CHECK_EQ(brStage.dirty, 0);
+  CHECK(headAt(down + 2));
+
+  return checkDone("test_longpress");
+}
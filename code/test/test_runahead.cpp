@@ -0,0 +1,115 @@
+/* ---------------------------------------------------------------------------
+ *  Run-ahead frames against inline rendering
+ *  -----------------------------------------
+ *  The same script of lamp changes is played through the ESP32 frame timer
+ *  twice: by this program with the ring (RUN_AHEAD) and by test_runahead0,
+ *  the same source built with RUN_AHEAD=0.  Every millisecond the strips'
+ *  bytes are sampled; both traces must agree frame by frame.  The script
+ *  moves blink origins, the preview colour and brightness under running
+ *  features without touching the state word, which the ring must notice.
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include "check.h"
+#include <string>
+#include <vector>
+
+static std::vector<std::string> trace;
+static uint32_t                 ms;
+
+/* One line per change of the strips: "ms bytes…" */
+static void sample()
+{
+  static std::string last;
+  std::string        line;
+  char               hex[3];
+  for (uint8_t s = 0; s < NUM_STRIPS; ++s)
+    for (uint16_t i = 0; i < 3 * strips[s]->numPixels(); ++i) {
+      snprintf(hex, sizeof hex, "%02x", strips[s]->getPixels()[i]);
+      line += hex;
+    }
+  if (line == last) return;
+  last = line;
+  trace.push_back(std::to_string(ms) + " " + line);
+}
+
+static void run(uint32_t n)
+{
+  for (uint32_t t = 0; t < n; ++t, ++ms) { loop(); host::advanceMs(1); sample(); }
+}
+
+static void play()
+{
+  setup();
+  run(100);
+
+  originSync(&LampScene::tOrgGyro);
+  stateSet(ST_GYRO | ST_TAIL | ST_HEAD);
+  run(1250);
+  turnSync();
+  stateUpdate(ST_TURN_L | ST_HAZARD, 0, ST_TURN_R);
+  run(1333);
+
+  /* Origins moved under running features: only the scene changes */
+  originSync(&LampScene::tOrgTurn);
+  run(777);
+  originSync(&LampScene::tOrgGyro);
+  gScene.write([](LampScene &s){ s.tOrgTurn += HP_TURN / 3; });
+  run(1500);
+
+  /* Live preview colour, rewritten while previewing */
+  gScene.write([](LampScene &s){ s.cfgColour = 0x203040; });
+  stateSet(ST_CFG_TAIL_COL);
+  run(300);
+  gScene.write([](LampScene &s){ s.cfgColour = 0x405060; });
+  run(300);
+  stateClear(ST_CFG_TAIL_COL);
+
+  /* Patterns, brightness, presets and a new tempo */
+  patternSelect(STRIP_TURN, PAT_DOUBLE);
+  run(1100);
+  brStage.level[STRIP_GYRO] = 30;
+  brStage.dirty |= _BV(STRIP_GYRO);
+  brCommit();
+  run(700);
+  gPresets.write([](Presets &p){ p.colTurnInit = 0xFF4000; });
+  run(900);
+  tempoSet(461);
+  stateSet(ST_HAZARD);
+  run(2000);
+  stateClear(ST_HAZARD | ST_GYRO);
+  run(1000);
+}
+
+int main(int argc, char **argv)
+{
+  play();
+#if RUN_AHEAD == 0
+  if (argc > 1) {                              // the reference, for test_runahead
+    for (const std::string &l : trace) puts(l.c_str());
+    return 0;
+  }
+  printf("runahead0: %zu frames inline\n", trace.size());
+  return checkDone("test_runahead0");
+#else
+  FILE *in = popen("build/test_runahead0 trace", "r");
+  CHECK(in != nullptr);
+  std::vector<std::string> ref;
+  char                     buf[4096];
+  while (in && fgets(buf, sizeof buf, in)) ref.emplace_back(buf, strcspn(buf, "\n"));
+  if (in) CHECK_EQ(pclose(in), 0);
+
+  size_t same = 0;
+  while (same < trace.size() && same < ref.size() && trace[same] == ref[same]) same++;
+  if (same < trace.size() || same < ref.size())
+    fprintf(stderr, "frame %zu differs:\n  ahead  %s\n  inline %s\n", same,
+            same < trace.size() ? trace[same].c_str() : "(none)",
+            same < ref.size() ? ref[same].c_str() : "(none)");
+  printf("runahead: %zu frames, %zu equal to inline, %u from the ring\n",
+         trace.size(), same, jitter[JIT_AHEAD].n);
+  CHECK(trace.size() > 50);
+  CHECK_EQ(same, ref.size());
+  CHECK_EQ(trace.size(), ref.size());
+  CHECK(jitter[JIT_AHEAD].n > 20);             // the ring was really used
+  return checkDone("test_runahead");
+#endif
+}
@@ -0,0 +1,2 @@
+/* test_runahead.cpp built with RUN_AHEAD=0: the inline reference */
+#include "test_runahead.cpp"
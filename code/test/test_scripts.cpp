@@ -0,0 +1,86 @@
+/* ---------------------------------------------------------------------------
+ *  Effect scripts: 100 concurrent, resumed on time and on events
+ *  -------------------------------------------------------------
+ *  Built with MAX_SCRIPTS=100, once as protothreads (C++17) and once as
+ *  C++20 coroutines (test_scripts_coro).  Each ticker sleeps its own
+ *  period; after the run its count must match the period exactly, since
+ *  SCRIPT_SLEEP advances a deadline and does not drift.
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include "check.h"
+
+static_assert(MAX_SCRIPTS >= 100, "build with -DMAX_SCRIPTS=100");
+
+static uint8_t periodOf(const Script &s) { return 1 + (&s - scripts) % 10; }
+
+SCRIPT(ticker)
+{
+  SCRIPT_BEGIN();
+  for (;;) {
+    self.i++;
+    SCRIPT_SLEEP(periodOf(self));
+  }
+  SCRIPT_END();
+}
+
+SCRIPT(waiter)
+{
+  SCRIPT_BEGIN();
+  for (;;) {
+    SCRIPT_WAIT(EV_TOUCH);
+    self.i++;
+  }
+  SCRIPT_END();
+}
+
+SCRIPT(oneShot)
+{
+  SCRIPT_BEGIN();
+  self.i = 1;
+  SCRIPT_SLEEP(5);
+  self.i = 2;
+  SCRIPT_END();
+}
+
+static void runFor(uint32_t ms)
+{
+  for (uint32_t t = 0; t < ms; ++t) { host::advanceMs(1); scriptsRun(tempoNow()); }
+}
+
+int main()
+{
+  constexpr uint32_t RUN_MS = 2520;             // a multiple of every period 1…10
+
+  for (int k = 0; k < 90; ++k) CHECK(scriptStart(ticker));
+  for (int k = 0; k < 10; ++k) CHECK(scriptStart(waiter));
+  CHECK(MAX_SCRIPTS > 100 || !scriptStart(ticker));          // slots are full
+
+  scriptsRun(tempoNow());                      // first resume at start
+  runFor(RUN_MS);
+
+  for (int k = 0; k < 90; ++k)
+    CHECK_EQ(scripts[k].i, RUN_MS / periodOf(scripts[k]) + 1);
+  for (int k = 90; k < 100; ++k) CHECK_EQ(scripts[k].i, 0);
+
+  /* One post wakes every waiter once, on the next run only */
+  scriptPost(EV_TOUCH);
+  runFor(10);
+  for (int k = 90; k < 100; ++k) CHECK_EQ(scripts[k].i, 1);
+
+  /* Stopping frees the slots; a finished script frees its own */
+  scriptStop(ticker);
+  uint32_t used = 0;
+  for (const Script &s : scripts) used += s.fn != nullptr;
+  CHECK_EQ(used, 10);
+  CHECK(scriptStart(oneShot));
+  scriptsRun(tempoNow());
+  runFor(10);
+  used = 0;
+  for (const Script &s : scripts) used += s.fn != nullptr;
+  CHECK_EQ(used, 10);
+
+  scriptsStopAll();
+  printf("scripts: 100 concurrent (%s), %zu bytes per slot\n",
+         SCRIPT_COROUTINES ? "coroutines" : "protothreads", sizeof(Script));
+  return checkDone(SCRIPT_COROUTINES ? "test_scripts_coro" : "test_scripts");
+}
@@ -0,0 +1,2 @@
+/* test_scripts.cpp built as C++20 coroutines */
+#include "test_scripts.cpp"
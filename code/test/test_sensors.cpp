@@ -0,0 +1,77 @@
+/* ---------------------------------------------------------------------------
+ *  Four sensors: electrode mapping, bring-up and IRQ-gated bursts
+ *  --------------------------------------------------------------
+ *  Built with NUM_TOUCH_SENSORS=4; sensors 1 and 2 have an IRQ line, 0 and
+ *  3 do not.  All four must come up, a quiet IRQ sensor must only be burst
+ *  every TOUCH_REFRESH_MS while the others are burst every pass, and a
+ *  touch must land on its own bit of the 48-bit mask – at once after its
+ *  IRQ, on the next pass for a polled sensor.
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include "check.h"
+
+static_assert(NUM_TOUCH_SENSORS == 4, "built with -DNUM_TOUCH_SENSORS=4");
+static_assert(TOUCH_IRQ_PIN[1] == 25 && TOUCH_IRQ_PIN[2] == 26, "IRQs on sensors 1 and 2");
+static_assert(SENSORS_ALL == 0x0F, "one up bit per sensor");
+static_assert(tk(0, 0) == 1 && tk(11, 0) == 1u << 11, "sensor 0 is bits 0…11");
+static_assert(tk(0, 1) == 1u << 12 && tk(3, 2) == 1u << 27, "12 bits per sensor");
+static_assert(tk(11, 3) == TouchMask(1) << 47, "sensor 3 ends at bit 47");
+
+static void run(uint32_t ms)
+{
+  for (uint32_t t = 0; t < ms; ++t) { loop(); host::advanceMs(1); }
+}
+
+/* ms until touchState() shows `bits`, at most `limit` */
+static uint32_t until(TouchMask bits, uint32_t limit)
+{
+  uint32_t ms = 0;
+  while (touchState() != bits && ms < limit) { run(1); ms++; }
+  return ms;
+}
+
+int main()
+{
+  setup();
+  run(100);
+  CHECK_EQ(gSensorsUp.load(), SENSORS_ALL);
+
+  /* Quiet: IRQ sensors on the refresh only, the others every pass */
+  uint32_t r0[4];
+  for (uint8_t n = 0; n < 4; ++n) r0[n] = host::mpr[n].reads;
+  uint64_t t0 = host::us;
+  run(400);
+  uint32_t W = (host::us - t0) / 1000;         // the bursts take bus time too
+  uint32_t r[4];
+  for (uint8_t n = 0; n < 4; ++n) r[n] = host::mpr[n].reads - r0[n];
+  printf("sensors: %u ms quiet, bursts per sensor %u %u %u %u (poll %u us, refresh %u ms)\n",
+         W, r[0], r[1], r[2], r[3], TOUCH_POLL_US, TOUCH_REFRESH_MS);
+  CHECK(r[0] >= W * 1000 / TOUCH_POLL_US * 3 / 4);
+  CHECK(r[3] >= W * 1000 / TOUCH_POLL_US * 3 / 4);
+  for (uint8_t n : { 1, 2 }) {
+    CHECK(r[n] <= W / TOUCH_REFRESH_MS + 1);
+    CHECK(r[n] >= W / (2 * TOUCH_REFRESH_MS));
+    CHECK(r[n] < r[0] / 2);
+  }
+
+  /* An IRQ sensor's touch arrives with its IRQ, not with the refresh */
+  host::mpr[2].setTouched(1 << 3);
+  host::irq(26);
+  uint32_t ms = until(tk(3, 2), 50);
+  CHECK(ms <= TOUCH_POLL_US / 1000 + 1);
+  CHECK(ms < TOUCH_REFRESH_MS);
+
+  /* A polled sensor's touch arrives on the next pass; both bits stay apart */
+  host::mpr[3].setTouched(1 << 11);
+  ms = until(tk(3, 2) | tk(11, 3), 50);
+  CHECK(ms <= TOUCH_POLL_US / 1000 + 1);
+
+  /* Release without an IRQ: the refresh still picks it up */
+  host::mpr[2].setTouched(0);
+  ms = until(tk(11, 3), 50);
+  CHECK(ms <= TOUCH_REFRESH_MS + TOUCH_POLL_US / 1000 + 1);
+  host::mpr[3].setTouched(0);
+  CHECK_EQ(until(0, 50) < 50, 1);
+
+  return checkDone("test_sensors");
+}
@@ -0,0 +1,155 @@
+/* ---------------------------------------------------------------------------
+ *  Low-power sleep: the idle state machine and the wake path
+ *  ---------------------------------------------------------
+ *  Runs the sketch as an ESP32 with sensor 0's IRQ wired.  Each scenario
+ *  runs in a forked child up to esp_deep_sleep_start(), which hands the RTC
+ *  variables and the sensor registers back through a pipe.  The parent then
+ *  boots a fresh image from them with an ext0 wake cause and times the
+ *  restore.  Time is the stub clock: the LED transmits and the I2C
+ *  transfers cost their wire time, nothing else does.
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include "check.h"
+#include <unistd.h>
+#include <sys/wait.h>
+
+struct SleepImage {
+  bool     slept;
+  uint64_t tSleepUs;
+  uint64_t tLastTouchUs;
+  uint32_t magic, state;
+  uint8_t  presets[sizeof(Presets)];
+  uint8_t  pattern[NUM_STRIPS];
+  uint8_t  ecr, config2;
+  bool     dark, irqPulled;
+};
+
+static int      pipeFd = -1;
+static uint64_t tLastTouch = 0;
+
+static void run(uint32_t ms)
+{
+  for (uint32_t t = 0; t < ms; ++t) { loop(); host::advanceMs(1); }
+}
+
+/* Finger on electrodes `bits` for `ms`, then off; the chip raises its IRQ */
+static void press(uint16_t bits, uint32_t ms)
+{
+  host::mpr[0].setTouched(bits);
+  host::irq(TOUCH_IRQ0);
+  run(ms);
+  host::mpr[0].setTouched(0);
+  host::irq(TOUCH_IRQ0);
+  tLastTouch = host::us;
+}
+
+static bool stripsDark()
+{
+  for (uint8_t k = 0; k < 3 * NUM_HEADTAIL_PIXELS; ++k) if (pxMain.backend().wire[k]) return false;
+  for (uint8_t k = 0; k < 3 * NUM_TURN_PIXELS; ++k)     if (pxTurn.backend().wire[k]) return false;
+  for (uint8_t k = 0; k < 3 * NUM_GYRO_PIXELS; ++k)     if (pxGyro.backend().wire[k]) return false;
+  return true;
+}
+
+static void onSleep()
+{
+  SleepImage im = {};
+  im.slept        = true;
+  im.tSleepUs     = host::us;
+  im.tLastTouchUs = tLastTouch;
+  im.magic        = rtcMagic;
+  im.state        = rtcState;
+  memcpy(im.presets, rtcPresets, sizeof im.presets);
+  memcpy(im.pattern, rtcPattern, sizeof im.pattern);
+  im.ecr          = host::mpr[0].reg[MPR_ECR];
+  im.config2      = host::mpr[0].reg[MPR_CONFIG2];
+  im.dark         = stripsDark();
+  im.irqPulled    = (host::rtcPullup >> TOUCH_IRQ0 & 1) && !(host::rtcPulldown >> TOUCH_IRQ0 & 1);
+  ssize_t n = write(pipeFd, &im, sizeof im);
+  _exit(n == sizeof im ? 0 : 1);
+}
+
+/* Cold boot, `scenario` in the child, up to `limitMs` of idling after it */
+template<typename Fn>
+static SleepImage runChild(Fn scenario, uint32_t limitMs)
+{
+  int fd[2];
+  if (pipe(fd)) { perror("pipe"); exit(1); }
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fd[0]);
+    pipeFd           = fd[1];
+    host::onDeepSleep = onSleep;
+    setup();
+    run(100);                                  // sensors up
+    scenario();
+    run(limitMs);
+    SleepImage none = {};
+    ssize_t n = write(pipeFd, &none, sizeof none);
+    _exit(n == sizeof none ? 0 : 1);
+  }
+  close(fd[1]);
+  SleepImage im = {};
+  if (read(fd[0], &im, sizeof im) != sizeof im) CHECK(!"child sent no image");
+  close(fd[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+  return im;
+}
+
+int main()
+{
+  static_assert(LOW_POWER, "build with -DTOUCH_IRQ0=<gpio>");
+  for (uint8_t e = 0; e < NUM_CHANNELS; ++e) host::mpr[0].setElectrode(e, 700, 700);
+
+  /* Head lamp on, then idle: sleeps IDLE_SLEEP_MS after the last touch; the
+     gyro's pattern goes into RTC memory with it */
+  SleepImage im = runChild([] { patternSelect(STRIP_GYRO, PAT_WIGWAG);
+                                press(uint16_t(TK_HEAD), 60); }, IDLE_SLEEP_MS + 5000);
+  CHECK(im.slept);
+  CHECK_EQ(im.magic, RTC_MAGIC);
+  CHECK_EQ(im.state, ST_HEAD);
+  CHECK_EQ(im.ecr, ECR_PROX_ONLY);
+  CHECK_EQ(im.config2, CONFIG2_SLEEP);
+  CHECK(im.dark);
+  CHECK(im.irqPulled);                         // or the wake line floats
+  long idleMs = long((im.tSleepUs - im.tLastTouchUs) / 1000);
+  CHECK(idleMs >= long(IDLE_SLEEP_MS) - 1 && idleMs <= long(IDLE_SLEEP_MS) + 50);   // from the release poll
+
+  /* Anything blinking holds the MCU awake */
+  SleepImage gy = runChild([] { press(uint16_t(TK_GYRO), 60); }, 2 * IDLE_SLEEP_MS);
+  CHECK(!gy.slept);
+  SleepImage hp = runChild([] { patternSelect(STRIP_MAIN, PAT_DOUBLE);
+                                press(uint16_t(TK_HEAD), 60); }, 2 * IDLE_SLEEP_MS);
+  CHECK(!hp.slept);
+
+  /* Wake: a fresh image boots from the RTC variables with an ext0 cause */
+  host::us        = 0;
+  host::wakeCause = ESP_SLEEP_WAKEUP_EXT0;
+  rtcMagic        = im.magic;
+  rtcState        = im.state;
+  memcpy(rtcPresets, im.presets, sizeof im.presets);
+  memcpy(rtcPattern, im.pattern, sizeof im.pattern);
+  host::serialOut.clear();
+  setup();
+  uint64_t tFrame = host::us;                  // setup() to its first frame, on the stub clock
+  CHECK(host::serialOut.find("Wake → first frame") != std::string::npos);
+  CHECK(stateTest(ST_HEAD));
+  CHECK_EQ(scene().pattern[STRIP_GYRO], PAT_WIGWAG);
+  CHECK(!stripsDark());
+  uint64_t wire = 0;                           // every strip sent once
+  for (PixelBuffer *px : strips) wire += px->numPixels() * 24 * (LED_T0H_NS + LED_T0L_NS) / 1000;
+  CHECK(tFrame >= wire);
+  CHECK(tFrame <= wire + 1000);                // nothing but the transmits before it
+  CHECK(tFrame <= uint64_t(FIRST_FRAME_MS) * 1000);
+  CHECK_EQ(rtcMagic, 0);                       // consumed
+
+  while (gSensorsUp.load() != SENSORS_ALL && host::us < 1000000) run(1);
+  uint64_t tUp = host::us;
+  CHECK_EQ(gSensorsUp.load(), SENSORS_ALL);
+
+  printf("sleep: after %ld ms idle; wake -> first frame %llu us, -> sensor up %llu us\n",
+         idleMs, (unsigned long long)tFrame, (unsigned long long)tUp);
+  return checkDone("test_sleep");
+}
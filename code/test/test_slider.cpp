@@ -0,0 +1,40 @@
+/* ---------------------------------------------------------------------------
+ *  INPUT_SLIDER: slider electrodes are a position, never keys, and a
+ *  brightness config loop opens on the stored brightness
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include "check.h"
+
+static void run(uint32_t ms)
+{
+  for (uint32_t t = 0; t < ms; ++t) { loop(); host::advanceMs(1); }
+}
+
+int main()
+{
+  for (uint8_t e = 0; e < NUM_CHANNELS; ++e) host::mpr[0].setElectrode(e, 700, 700);
+  setup();
+  run(100);
+
+  /* Finger on the middle slider electrode, as the chip reports it */
+  uint8_t mid = SLIDER_FIRST + SLIDER_COUNT / 2;
+  host::mpr[0].setElectrode(mid, 660, 700);
+  host::mpr[0].setTouched(_BV(mid));
+  run(20);
+  CHECK_EQ(gTouchMask.load() & SLIDER_BITS, 0);
+  CHECK_EQ(gSliderPos.load(), SLIDER_MAX / 2);
+
+  /* Lift: keys stay clear, the position holds */
+  host::mpr[0].setElectrode(mid, 700, 700);
+  host::mpr[0].setTouched(0);
+  run(20);
+  CHECK_EQ(gTouchMask.load(), 0);
+  CHECK_EQ(gSliderPos.load(), SLIDER_MAX / 2);
+
+  /* Every stored brightness reads back unchanged through the pot mapping */
+  for (int br = 0; br < 256; ++br) {
+    sliderSeed(br);
+    CHECK_EQ(potToBrightness(readAdjust()), br);
+  }
+  return checkDone("test_slider");
+}
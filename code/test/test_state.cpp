@@ -0,0 +1,82 @@
+/* ---------------------------------------------------------------------------
+ *  State word and lamp scene under contention
+ *  ------------------------------------------
+ *  Right, left and hazard are toggled on their own threads the way loop()
+ *  and the long press do it, while a fourth flips head and tail and the
+ *  scene is rewritten underneath an observer.  No published word may have
+ *  both turn signals on, a turn signal that comes on must have cleared
+ *  hazard, no toggle may be lost, and every scene snapshot must be one
+ *  write.  Built with -fsanitize=thread by `make tsan` as well.
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include "check.h"
+#include <thread>
+
+constexpr uint32_t N = 100000;                 // toggles per thread, even
+
+std::atomic<bool>     started{false};
+std::atomic<uint32_t> running{0}, badTurn{0};
+
+static void toggler(uint32_t bit, uint32_t clr)
+{
+  while (!started.load()) {}
+  for (uint32_t i = 0; i < N; ++i) {
+    uint32_t st = stateToggle(bit, clr);
+    if ((st & bit) && (st & clr)) badTurn++;
+    if (i % 256 == 0) std::this_thread::yield();
+  }
+  running--;
+}
+
+static void sceneWriter()                      // the loop rewriting the scene
+{
+  while (!started.load()) {}
+  for (uint32_t k = 1; k <= N; ++k) {
+    gScene.write([k](LampScene &s) {
+      s.tOrgGyro = s.tOrgTurn = s.tOrgHead = k;
+      s.cfgColour = k;
+      memset(s.pattern, uint8_t(k), sizeof s.pattern);
+    });
+    if (k % 256 == 0) std::this_thread::yield();
+  }
+  running--;
+}
+
+int main()
+{
+  running = 5;
+  std::thread ts[] = {
+    std::thread(toggler, ST_TURN_R, ST_TURN_L | ST_HAZARD),
+    std::thread(toggler, ST_TURN_L, ST_TURN_R | ST_HAZARD),
+    std::thread(toggler, ST_HAZARD, 0),
+    std::thread(toggler, ST_HEAD | ST_TAIL, 0),
+    std::thread(sceneWriter),
+  };
+
+  uint32_t reads = 0, bothTurns = 0, torn = 0;
+  started = true;
+  while (running.load()) {
+    uint32_t  st = stateSnapshot();
+    LampScene sc = gScene.snapshot();
+    bothTurns += (st & ST_TURN_R) && (st & ST_TURN_L);
+    bool ok = sc.tOrgTurn == sc.tOrgGyro && sc.tOrgHead == sc.tOrgGyro &&
+              sc.cfgColour == sc.tOrgGyro;
+    for (uint8_t p : sc.pattern) ok &= p == uint8_t(sc.tOrgGyro);
+    torn += !ok;
+    reads++;
+  }
+  for (std::thread &t : ts) t.join();
+
+  uint32_t st = stateSnapshot();
+  CHECK_EQ(badTurn.load(), 0);
+  CHECK_EQ(bothTurns, 0);
+  CHECK_EQ(torn, 0);
+  CHECK(!((st & ST_TURN_R) && (st & ST_TURN_L)));
+  CHECK_EQ(st & (ST_HEAD | ST_TAIL), 0);       // an even number of flips each
+  CHECK_EQ(gScene.snapshot().cfgColour, N);
+  CHECK(reads > 0);
+
+  printf("state: %u toggles on 4 threads, %u observed words, turn signals exclusive\n",
+         4 * N, reads);
+  return checkDone("test_state");
+}
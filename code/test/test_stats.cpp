@@ -0,0 +1,64 @@
+/* ---------------------------------------------------------------------------
+ *  Baseline drift in the 's' report
+ *  --------------------------------
+ *  Electrode 0's baselines are fed directly: first far off the data (the
+ *  chip still learning), then settled at 700, wandering up to 740 and down
+ *  to 680, ending at 720.  The report must take baseline0 from the settled
+ *  samples, not the first one, and give min 680, max 740, drift +20.
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include "check.h"
+
+static void run(uint32_t ms)
+{
+  for (uint32_t t = 0; t < ms; ++t) { loop(); host::advanceMs(1); }
+}
+
+/* Every electrode at `base`, the data on it (settled) or 200 above */
+static void feed(uint16_t base, bool settled)
+{
+  for (uint8_t e = 0; e < NUM_CHANNELS; ++e) host::mpr[0].setElectrode(e, settled ? base : base + 200, base);
+}
+
+/* Baseline of electrode 0 moved by 4 counts (one register step) per 10 ms */
+static void ramp(uint16_t from, uint16_t to)
+{
+  for (uint16_t b = from; b != to; b = b < to ? b + 4 : b - 4) { feed(b, true); run(10); }
+  feed(to, true);
+  run(10);
+}
+
+int main()
+{
+  feed(500, false);                            // power-on: baselines still learning
+  setup();
+  run(200);
+  CHECK_EQ(stats[0][0].baseline0, 0);
+
+  feed(700, true);
+  run(200);
+  ramp(700, 740);
+  ramp(740, 680);
+  ramp(680, 720);
+
+  host::serialOut.clear();
+  host::serialIn = "s";
+  run(50);
+  size_t at = host::serialOut.find("\n0 0 ");
+  CHECK(at != std::string::npos);
+  long base = -1, lo = -1, hi = -1, drift = -1;
+  if (at != std::string::npos)
+    sscanf(host::serialOut.c_str() + at + 5, "%ld %ld %ld %ld", &base, &lo, &hi, &drift);
+  printf("stats: baseline0 %ld, min %ld, max %ld, drift %+ld\n", base, lo, hi, drift);
+  CHECK_EQ(base, 700);
+  CHECK_EQ(lo, 680);
+  CHECK_EQ(hi, 740);
+  CHECK_EQ(drift, 20);
+
+  /* 'r' starts over from the next settled samples */
+  host::serialIn = "r";
+  run(50);
+  CHECK_EQ(stats[0][0].baseline0, 720);
+  CHECK_EQ(stats[0][0].drift, 0);
+  return checkDone("test_stats");
+}
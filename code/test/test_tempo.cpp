@@ -0,0 +1,87 @@
+/* ---------------------------------------------------------------------------
+ *  Tempo clock: tapped tempo and the phase slew
+ *  -------------------------------------------
+ *  At 40 … 240 BPM four taps are given off the current beat grid, and the
+ *  clock is ticked in uneven µs steps from there.  Tempo time must never run
+ *  backwards, must move at the tapped rate ± 1/TEMPO_SLEW_DIV of real time
+ *  while slewing, and must end with its beat edges on the taps.
+ * ------------------------------------------------------------------------ */
+#include "../full_implementation.cpp"
+#include "check.h"
+
+static uint64_t tempoUs() { return uint64_t(tempo.tt) * 1000 + (tempo.frac >> 16); }
+
+int main()
+{
+  static const uint16_t BEATS[] = { 1500, 1000, 500, 461, 250 };   // 40 … 240 BPM
+  uint32_t r = 1;
+  for (uint16_t beat : BEATS) {
+    for (uint16_t phase : { 120, 380 }) {      // edge pulled back / pushed on
+      tempo    = TempoClock();
+      tapTempo = TapTempo();
+      host::us = 0;
+      tempoTick(micros());
+      host::advance(uint64_t(phase) * 1000);
+      for (uint8_t k = 0; k < 4; ++k) {
+        tempoTap(millis());
+        if (k == 2) CHECK(tempo.slew != 0);    // the first tempo comes with a correction
+        if (k < 3) host::advance(uint64_t(beat) * 1000);
+      }
+      unsigned long tLastTap = millis();
+
+      uint64_t prev = tempoUs(), prevReal = host::us, backwards = 0, fast = 0, slow = 0;
+      while (host::us < prevReal + 30000000) {
+        uint64_t dt = 50 + ((r = r * 1664525u + 1013904223u) >> 22);   // 50 … 1073 µs
+        bool     slewing = tempo.slew != 0;
+        host::advance(dt);
+        tempoNow();
+        uint64_t t    = tempoUs();
+        double   rate = double(tempo.rate) / 65536, d = double(t) - double(prev);
+        backwards += t < prev;
+        if (slewing) {
+          fast += d > dt * (rate + 1.0 / TEMPO_SLEW_DIV) + 2;
+          slow += d < dt * (rate - 1.0 / TEMPO_SLEW_DIV) - 2 && d > 0;
+        }
+        prev = t;
+      }
+      CHECK_EQ(backwards, 0);
+      CHECK_EQ(fast, 0);
+      CHECK_EQ(slow, 0);
+      CHECK_EQ(tempo.slew, 0);
+
+      /* A tap-period later than the last tap, tempo sits on a beat edge */
+      unsigned long n  = (millis() - tLastTap) / beat + 1;
+      host::advance(uint64_t(tLastTap + n * beat) * 1000 - host::us);
+      long off = long(tempoNow() % TEMPO_BEAT_MS);
+      if (off > TEMPO_BEAT_MS / 2) off -= TEMPO_BEAT_MS;
+      printf("tempo: beat %4u ms, tapped %3u ms off the grid: on the taps to %ld ms\n",
+             beat, phase, off);
+      CHECK(off >= -2 && off <= 2);
+    }
+  }
+
+  /* The median holds the beat through one late tap and one missed tap */
+  static const uint16_t ODD[][5] = {
+    { 500, 500, 650, 350, 500 },               // one tap 150 ms late
+    { 500, 500, 1000, 500, 500 },              // one tap missed
+  };
+  for (const uint16_t *iv : ODD) {
+    tapTempo = TapTempo();
+    tempoTap(millis());
+    for (uint8_t k = 0; k < 5; ++k) { host::advance(uint64_t(iv[k]) * 1000); tempoTap(millis()); }
+    printf("tempo: intervals %u %u %u %u %u: %u ms beat\n", iv[0], iv[1], iv[2], iv[3], iv[4],
+           unsigned((uint32_t(TEMPO_BEAT_MS) << 16) / tempo.rate));
+    CHECK_EQ(tempo.rate, (uint32_t(TEMPO_BEAT_MS) << 16) / 500);
+  }
+
+  /* A long count keeps counting: every tap from the third on sets the tempo */
+  tapTempo = TapTempo();
+  host::serialOut.clear();
+  for (uint16_t k = 0; k < 300; ++k) { tempoTap(millis()); host::advance(400000); }
+  size_t sets = 0;
+  for (size_t at = 0; (at = host::serialOut.find("Tempo ", at)) != std::string::npos; ++at) sets++;
+  CHECK_EQ(sets, 298);
+  CHECK(tapTempo.n > TAP_HISTORY && tapTempo.n <= 2 * TAP_HISTORY);
+  CHECK_EQ(tempo.rate, (uint32_t(TEMPO_BEAT_MS) << 16) / 400);
+  return checkDone("test_tempo");
+}